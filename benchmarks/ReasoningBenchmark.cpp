@@ -0,0 +1,785 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../rete-reasoner/RuleParser.hpp"
+#include "../rete-reasoner/Reasoner.hpp"
+#include "../rete-reasoner/AssertedEvidence.hpp"
+#include "../rete-rdf/ReteRDF.hpp"
+
+// the simple mutable WME of the tests, to have something to UPDATE
+#include "../test/MutableWME.hpp"
+
+#ifndef RETE_BUILD_TYPE
+#define RETE_BUILD_TYPE ""
+#endif
+
+using namespace rete;
+
+/**
+    Synthetic workloads to measure the performance of the reasoner, e.g. to compare two versions
+    of the library. Every workload builds its own reasoner, rules and data, and is executed in a
+    process of its own so that the peak memory usage of one does not hide that of the next.
+
+    The workloads consist of phases (e.g. loading data, then removing it). Every phase is a
+    sequence of timed samples, each of which processes a number of operations (e.g. asserting a
+    batch of facts and performing the inference). For every phase the throughput (operations per
+    second), the percentiles of the latencies of the samples, the number of WMEs afterwards and the
+    peak memory are reported -- the resident set size of the process as well as the usage
+    accounted by Reasoner::getMemoryUsage().
+
+    The size of the data is scaled with --scale, so the defaults should take a few seconds each in
+    an optimized build.
+*/
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Batch = std::vector<std::pair<WME::Ptr, Evidence::Ptr>>;
+
+struct Params {
+    double scale = 1.0;
+    size_t threads = 1;
+    unsigned seed = 42;
+    bool csv = false;
+};
+
+/**
+    The timed samples of one phase of a workload.
+*/
+struct Phase {
+    std::string name;
+    std::string unit;   // what counts as an operation
+    size_t ops = 0;
+    size_t facts = 0;   // WMEs in the reasoner at the end of the phase
+    std::vector<double> latencies; // seconds per sample
+
+    template <class F>
+    void sample(size_t n, F&& f)
+    {
+        auto start = Clock::now();
+        f();
+        latencies.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+        ops += n;
+    }
+
+    double seconds() const
+    {
+        return std::accumulate(latencies.begin(), latencies.end(), 0.0);
+    }
+
+    /**
+        Nearest-rank percentile of the latencies, in microseconds
+    */
+    double percentile(double p) const
+    {
+        if (latencies.empty()) return 0;
+        std::vector<double> sorted(latencies);
+        std::sort(sorted.begin(), sorted.end());
+        size_t rank = static_cast<size_t>(p / 100.0 * sorted.size() + 0.5);
+        rank = std::min(std::max<size_t>(rank, 1), sorted.size());
+        return sorted[rank - 1] * 1e6;
+    }
+};
+
+/**
+    Everything a workload needs: The parameters, and where to put the measurements.
+*/
+class Benchmark {
+    std::deque<Phase> phases_;
+    size_t accountedPeak_ = 0;
+
+public:
+    Params params;
+
+    /**
+        The given default size, multiplied by the scale. At least 1.
+    */
+    size_t scaled(size_t n) const
+    {
+        return std::max<size_t>(1, static_cast<size_t>(n * params.scale));
+    }
+
+    Phase& phase(const std::string& name, const std::string& unit)
+    {
+        phases_.emplace_back();
+        phases_.back().name = name;
+        phases_.back().unit = unit;
+        return phases_.back();
+    }
+
+    /**
+        Remembers the state of the reasoner at the end of a phase
+    */
+    void finish(Phase& phase, const Reasoner& reasoner)
+    {
+        phase.facts = reasoner.getCurrentState().numWMEs();
+        accountedPeak_ = std::max(accountedPeak_, reasoner.getMemoryUsage());
+    }
+
+    void print(const std::string& workload) const;
+};
+
+void Benchmark::print(const std::string& workload) const
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    double rss = usage.ru_maxrss / 1024.0; // kilobytes on linux
+    double accounted = accountedPeak_ / (1024.0 * 1024.0);
+
+    for (auto& phase : phases_)
+    {
+        double seconds = phase.seconds();
+        double throughput = seconds > 0 ? phase.ops / seconds : 0;
+
+        if (params.csv)
+        {
+            std::cout << workload << "," << phase.name << "," << phase.ops << ","
+                      << phase.unit << "," << seconds << "," << throughput << ","
+                      << phase.percentile(50) << "," << phase.percentile(90) << ","
+                      << phase.percentile(99) << "," << phase.percentile(100) << ","
+                      << phase.facts << "," << rss << "," << accounted << std::endl;
+        }
+        else
+        {
+            std::cout << std::left << std::setw(18) << workload
+                      << std::setw(10) << phase.name
+                      << std::right << std::setw(9) << phase.ops << " "
+                      << std::left << std::setw(8) << phase.unit
+                      << std::right << std::fixed
+                      << std::setprecision(3) << std::setw(9) << seconds
+                      << std::setprecision(0) << std::setw(11) << throughput
+                      << std::setprecision(1)
+                      << std::setw(10) << phase.percentile(50)
+                      << std::setw(10) << phase.percentile(90)
+                      << std::setw(10) << phase.percentile(99)
+                      << std::setw(11) << phase.percentile(100)
+                      << std::setw(9) << phase.facts
+                      << std::setw(9) << rss
+                      << std::setw(9) << accounted << std::endl;
+        }
+    }
+}
+
+void printHeader(const Params& params)
+{
+    std::string buildType = RETE_BUILD_TYPE;
+    if (buildType.empty()) buildType = "none (not optimized?)";
+
+    std::cout << "# build type: " << buildType << ", scale: " << params.scale
+              << ", threads: " << params.threads << ", seed: " << params.seed << std::endl;
+    if (params.csv)
+    {
+        std::cout << "workload,phase,ops,unit,seconds,ops_per_second,"
+                     "p50_us,p90_us,p99_us,max_us,facts,peak_rss_mb,accounted_mb" << std::endl;
+    }
+    else
+    {
+        std::cout << std::left << std::setw(18) << "workload"
+                  << std::setw(10) << "phase"
+                  << std::right << std::setw(9) << "ops" << " "
+                  << std::left << std::setw(8) << "unit"
+                  << std::right
+                  << std::setw(9) << "time[s]"
+                  << std::setw(11) << "ops/s"
+                  << std::setw(10) << "p50[us]"
+                  << std::setw(10) << "p90[us]"
+                  << std::setw(10) << "p99[us]"
+                  << std::setw(11) << "max[us]"
+                  << std::setw(9) << "facts"
+                  << std::setw(9) << "rss[MB]"
+                  << std::setw(9) << "acc[MB]" << std::endl;
+    }
+}
+
+
+WME::Ptr triple(const std::string& s, const std::string& p, const std::string& o)
+{
+    return std::make_shared<Triple>(s, p, o);
+}
+
+std::string iri(const std::string& prefix, size_t i)
+{
+    return "<" + prefix + std::to_string(i) + ">";
+}
+
+std::string literal(const std::string& prefix, size_t i)
+{
+    return "\"" + prefix + std::to_string(i) + "\"";
+}
+
+/**
+    Adds the facts in batches of the given size, one sample per batch.
+*/
+void load(Reasoner& reasoner, Phase& phase, const Batch& facts, size_t batchSize)
+{
+    for (size_t i = 0; i < facts.size(); i += batchSize)
+    {
+        Batch batch(facts.begin() + i, facts.begin() + std::min(facts.size(), i + batchSize));
+        phase.sample(batch.size(),
+            [&]()
+            {
+                reasoner.addEvidence(batch);
+                reasoner.performInference();
+            });
+    }
+}
+
+const std::string taxonomyRules =
+    "[subclass: (?a <subClassOf> ?b), (?b <subClassOf> ?c) -> (?a <subClassOf> ?c)]"
+    "[type: (?x <type> ?a), (?a <subClassOf> ?b) -> (?x <type> ?b)]";
+
+/**
+    A binary tree of 31 classes, C0 being the root
+*/
+void addTaxonomy(Reasoner& reasoner)
+{
+    auto ev = std::make_shared<AssertedEvidence>("taxonomy");
+    for (size_t i = 1; i < 31; i++)
+    {
+        reasoner.addEvidence(triple(iri("C", i), "<subClassOf>", iri("C", (i - 1) / 2)), ev);
+    }
+    reasoner.performInference();
+}
+
+
+// ----------------------------------------------------------------------------
+// the workloads
+// ----------------------------------------------------------------------------
+
+/**
+    Loads instances of the leaf classes of a small taxonomy in batches. Every instance is
+    inferred to be of the 4 super classes, too.
+*/
+void bulkLoad(Benchmark& b)
+{
+    RuleParser parser;
+    Reasoner reasoner;
+    reasoner.setNumThreads(b.params.threads);
+    auto rules = parser.parseRules(taxonomyRules, reasoner.net());
+    addTaxonomy(reasoner);
+
+    auto ev = std::make_shared<AssertedEvidence>("instances");
+    Batch facts;
+    for (size_t i = 0; i < b.scaled(20000); i++)
+    {
+        facts.push_back({triple(iri("x", i), "<type>", iri("C", 15 + i % 16)), ev});
+    }
+
+    auto& phase = b.phase("load", "facts");
+    load(reasoner, phase, facts, 1000);
+    b.finish(phase, reasoner);
+}
+
+/**
+    Builds the transitive closure of a chain of classes with a few instances each. The edges of
+    the chain are added one by one in random order, so that segments of different lengths get
+    connected.
+*/
+void subClassOfClosure(Benchmark& b)
+{
+    RuleParser parser;
+    Reasoner reasoner;
+    reasoner.setNumThreads(b.params.threads);
+    auto rules = parser.parseRules(taxonomyRules, reasoner.net());
+
+    size_t n = b.scaled(100);
+    auto ev = std::make_shared<AssertedEvidence>("data");
+    Batch instances;
+    for (size_t i = 0; i < n; i++)
+    {
+        instances.push_back({triple(iri("x", 2 * i), "<type>", iri("C", i)), ev});
+        instances.push_back({triple(iri("x", 2 * i + 1), "<type>", iri("C", i)), ev});
+    }
+    reasoner.addEvidence(instances);
+    reasoner.performInference();
+
+    std::vector<size_t> edges(n - 1);
+    std::iota(edges.begin(), edges.end(), 0);
+    std::shuffle(edges.begin(), edges.end(), std::mt19937(b.params.seed));
+
+    auto& phase = b.phase("closure", "edges");
+    for (auto i : edges)
+    {
+        auto edge = triple(iri("C", i + 1), "<subClassOf>", iri("C", i));
+        phase.sample(1,
+            [&]()
+            {
+                reasoner.addEvidence(edge, ev);
+                reasoner.performInference();
+            });
+    }
+    b.finish(phase, reasoner);
+}
+
+/**
+    Loads entities with 6 properties each, property by property, which all need to be joined for
+    a match. Another rule joins the entities through shared values.
+*/
+void wideJoin(Benchmark& b)
+{
+    RuleParser parser;
+    Reasoner reasoner;
+    reasoner.setNumThreads(b.params.threads);
+    auto rules = parser.parseRules(
+        "[wide: (?x <p0> ?a), (?x <p1> ?b), (?x <p2> ?c), (?x <p3> ?d), (?x <p4> ?e),"
+        "       (?x <p5> ?f) -> (?x <complete> \"yes\")]"
+        "[pairs: (?x <p0> ?v), (?y <p5> ?v) -> (?x <pairedWith> ?y)]",
+        reasoner.net());
+
+    size_t n = b.scaled(20000);
+    size_t values = std::max<size_t>(1, n / 2);
+    auto ev = std::make_shared<AssertedEvidence>("data");
+    Batch facts;
+    for (size_t p = 0; p < 6; p++)
+    {
+        std::string predicate = iri("p", p);
+        for (size_t i = 0; i < n; i++)
+        {
+            facts.push_back({triple(iri("x", i), predicate, iri("v", (i * (p + 1)) % values)), ev});
+        }
+    }
+
+    auto& phase = b.phase("load", "facts");
+    load(reasoner, phase, facts, 1000);
+    b.finish(phase, reasoner);
+}
+
+/**
+    Tasks are free unless something blocks them, ready if their worker is not busy, and workers
+    are idle when no task is assigned to them. After loading, blockers and busy states are
+    toggled one at a time.
+*/
+void noValueHeavy(Benchmark& b)
+{
+    RuleParser parser;
+    Reasoner reasoner;
+    reasoner.setNumThreads(b.params.threads);
+    auto rules = parser.parseRules(
+        "[free: (?t <type> <Task>), noValue { (?t <blockedBy> ?b) } -> (?t <status> <free>)]"
+        "[ready: (?t <type> <Task>), (?t <assignedTo> ?w), noValue { (?w <busyWith> ?o) }"
+        "        -> (?t <status> <ready>)]"
+        "[idle: (?w <type> <Worker>), noValue { (?t <assignedTo> ?w) } -> (?w <status> <idle>)]",
+        reasoner.net());
+
+    size_t tasks = b.scaled(20000);
+    size_t workers = std::max<size_t>(1, tasks / 10);
+    auto ev = std::make_shared<AssertedEvidence>("data");
+    Batch facts;
+    for (size_t w = 0; w < workers; w++)
+    {
+        facts.push_back({triple(iri("w", w), "<type>", "<Worker>"), ev});
+    }
+    for (size_t t = 0; t < tasks; t++)
+    {
+        facts.push_back({triple(iri("t", t), "<type>", "<Task>"), ev});
+        if (t % 3 == 0) facts.push_back({triple(iri("t", t), "<assignedTo>", iri("w", t % workers)), ev});
+    }
+
+    auto& loading = b.phase("load", "facts");
+    load(reasoner, loading, facts, 1000);
+    b.finish(loading, reasoner);
+
+    std::mt19937 random(b.params.seed);
+    std::vector<WME::Ptr> blockers(tasks), busy(workers);
+    auto& toggle = b.phase("toggle", "toggles");
+    for (size_t i = 0; i < b.scaled(20000); i++)
+    {
+        // toggle either the blocker of a task or the busy state of a worker
+        WME::Ptr* entry;
+        WME::Ptr fact;
+        if (i % 2)
+        {
+            size_t t = random() % tasks;
+            entry = &blockers[t];
+            fact = triple(iri("t", t), "<blockedBy>", iri("t", (t + 1) % tasks));
+        }
+        else
+        {
+            size_t w = random() % workers;
+            entry = &busy[w];
+            fact = triple(iri("w", w), "<busyWith>", iri("o", w));
+        }
+
+        toggle.sample(1,
+            [&]()
+            {
+                if (*entry)
+                {
+                    reasoner.removeEvidence(*entry, ev);
+                    entry->reset();
+                }
+                else
+                {
+                    reasoner.addEvidence(fact, ev);
+                    *entry = fact;
+                }
+                reasoner.performInference();
+            });
+    }
+    b.finish(toggle, reasoner);
+}
+
+/**
+    Members with a score are added to and removed from a fixed number of groups, which
+    aggregate the number of members and the sum of their scores.
+*/
+void groupBy(Benchmark& b)
+{
+    RuleParser parser;
+    Reasoner reasoner;
+    reasoner.setNumThreads(b.params.threads);
+    auto rules = parser.parseRules(
+        "[size: (?x <memberOf> ?g), GROUP BY (?g), count(?c ?x) -> (?g <size> ?c)]"
+        "[total: (?x <memberOf> ?g), (?x <score> ?s), GROUP BY (?g), SumBulk(?t ?s)"
+        "        -> (?g <total> ?t)]",
+        reasoner.net());
+
+    size_t members = b.scaled(20000);
+    const size_t groups = 100;
+    const size_t batchSize = 100;
+
+    std::vector<Batch> batches;
+    for (size_t i = 0; i < members; i += batchSize)
+    {
+        auto ev = std::make_shared<AssertedEvidence>("batch" + std::to_string(i));
+        batches.emplace_back();
+        for (size_t j = i; j < std::min(members, i + batchSize); j++)
+        {
+            batches.back().push_back({triple(iri("x", j), "<memberOf>", iri("g", j % groups)), ev});
+            batches.back().push_back({triple(iri("x", j), "<score>", std::to_string(j % 100)), ev});
+        }
+    }
+
+    auto& insert = b.phase("insert", "members");
+    for (auto& batch : batches)
+    {
+        insert.sample(batch.size() / 2,
+            [&]()
+            {
+                reasoner.addEvidence(batch);
+                reasoner.performInference();
+            });
+    }
+    b.finish(insert, reasoner);
+
+    auto& remove = b.phase("remove", "members");
+    for (auto& batch : batches)
+    {
+        remove.sample(batch.size() / 2,
+            [&]()
+            {
+                reasoner.removeEvidence(batch.front().second);
+                reasoner.performInference();
+            });
+    }
+    b.finish(remove, reasoner);
+}
+
+/**
+    Loads typed instances and a symmetric relation between them (which leads to inference loops)
+    in chunks with an evidence each, and then removes the chunks one after the other.
+*/
+void massRetraction(Benchmark& b)
+{
+    RuleParser parser;
+    Reasoner reasoner;
+    reasoner.setNumThreads(b.params.threads);
+    auto rules = parser.parseRules(
+        taxonomyRules +
+        "[knows: (?a <knows> ?b) -> (?b <knows> ?a)]",
+        reasoner.net());
+    addTaxonomy(reasoner);
+
+    size_t n = b.scaled(20000);
+    const size_t chunkSize = 1000;
+    std::vector<Batch> chunks;
+    for (size_t i = 0; i < n; i += chunkSize)
+    {
+        auto ev = std::make_shared<AssertedEvidence>("chunk" + std::to_string(i));
+        chunks.emplace_back();
+        for (size_t j = i; j < std::min(n, i + chunkSize); j++)
+        {
+            chunks.back().push_back({triple(iri("x", j), "<type>", iri("C", 15 + j % 16)), ev});
+            if (j % 5 == 0) chunks.back().push_back({triple(iri("x", j), "<knows>", iri("x", (j * 7) % n)), ev});
+        }
+    }
+
+    auto& loading = b.phase("load", "facts");
+    for (auto& chunk : chunks)
+    {
+        loading.sample(chunk.size(),
+            [&]()
+            {
+                reasoner.addEvidence(chunk);
+                reasoner.performInference();
+            });
+    }
+    b.finish(loading, reasoner);
+
+    auto& retract = b.phase("retract", "facts");
+    for (auto& chunk : chunks)
+    {
+        retract.sample(chunk.size(),
+            [&]()
+            {
+                reasoner.removeEvidence(chunk.front().second);
+                reasoner.performInference();
+            });
+    }
+    b.finish(retract, reasoner);
+}
+
+/**
+    Changes the values of mutable WMEs one at a time, and propagates each change as an UPDATE.
+    The values are copied into triples, which are joined with other triples.
+*/
+void updateStorm(Benchmark& b)
+{
+    RuleParser parser;
+    parser.registerNodeBuilder<MutableNodeBuilder>();
+    Reasoner reasoner;
+    reasoner.setNumThreads(b.params.threads);
+    auto rules = parser.parseRules(
+        "[value: MutableWME(?v) -> (<mutable> <hasValue> ?v)]"
+        "[expect: (<mutable> <hasValue> ?v), (?x <expects> ?v) -> (?x <satisfied> ?v)]"
+        "[special: MutableWME(\"v0\") -> (<mutable> <special> \"yes\")]",
+        reasoner.net());
+
+    const size_t values = 50;
+    auto ev = std::make_shared<AssertedEvidence>("data");
+    for (size_t i = 0; i < values; i++)
+    {
+        reasoner.addEvidence(triple(iri("x", i), "<expects>", literal("v", i)), ev);
+    }
+
+    std::vector<MutableWME::Ptr> wmes;
+    for (size_t i = 0; i < b.scaled(1000); i++)
+    {
+        wmes.push_back(std::make_shared<MutableWME>());
+        wmes.back()->value_ = "v" + std::to_string(i % values);
+        reasoner.addEvidence(wmes.back(), ev);
+    }
+    reasoner.performInference();
+
+    std::mt19937 random(b.params.seed);
+    auto& phase = b.phase("update", "updates");
+    for (size_t i = 0; i < b.scaled(20000); i++)
+    {
+        auto& wme = wmes[random() % wmes.size()];
+        std::string value = "v" + std::to_string(random() % values);
+        phase.sample(1,
+            [&]()
+            {
+                wme->value_ = value;
+                reasoner.net().getRoot()->activate(wme, PropagationFlag::UPDATE);
+                reasoner.performInference();
+            });
+    }
+    b.finish(phase, reasoner);
+}
+
+/**
+    Adds a few rules to a reasoner that already holds data, and removes them again.
+*/
+void ruleChurn(Benchmark& b)
+{
+    RuleParser parser;
+    Reasoner reasoner;
+    reasoner.setNumThreads(b.params.threads);
+
+    size_t n = b.scaled(20000);
+    auto ev = std::make_shared<AssertedEvidence>("data");
+    Batch facts;
+    for (size_t i = 0; i < n; i++)
+    {
+        facts.push_back({triple(iri("x", i), "<type>", iri("C", i % 10)), ev});
+        facts.push_back({triple(iri("x", i), "<p>", iri("x", (i * 7 + 1) % n)), ev});
+        if (i % 2) facts.push_back({triple(iri("x", i), "<q>", iri("x", i / 2)), ev});
+    }
+    reasoner.addEvidence(facts);
+    reasoner.performInference();
+
+    const std::string churn =
+        "[links: (?x <type> <C0>), (?x <p> ?y), (?y <type> ?c) -> (?x <linksTo> ?c)]"
+        "[unmarked: (?x <type> <C1>), noValue { (?x <q> ?z) } -> (?x <unmarked> \"yes\")]"
+        "[instances: (?x <type> ?c), GROUP BY (?c), count(?n ?x) -> (?c <instances> ?n)]";
+
+    auto& add = b.phase("add", "rules");
+    auto& remove = b.phase("remove", "rules");
+    for (size_t i = 0; i < b.scaled(20); i++)
+    {
+        std::vector<ParsedRule::Ptr> rules;
+        add.sample(3,
+            [&]()
+            {
+                rules = parser.parseRules(churn, reasoner.net());
+                reasoner.performInference();
+            });
+        b.finish(add, reasoner);
+
+        remove.sample(3,
+            [&]()
+            {
+                rules.clear();
+                reasoner.performInference();
+            });
+        b.finish(remove, reasoner);
+    }
+}
+
+const std::vector<std::pair<std::string, std::function<void(Benchmark&)>>> workloads = {
+    { "bulk-load", bulkLoad },
+    { "subclass-closure", subClassOfClosure },
+    { "wide-join", wideJoin },
+    { "novalue", noValueHeavy },
+    { "group-by", groupBy },
+    { "retraction", massRetraction },
+    { "update-storm", updateStorm },
+    { "rule-churn", ruleChurn }
+};
+
+/**
+    Runs the workload in a child process, returns false if it failed.
+*/
+bool run(const std::string& name, const std::function<void(Benchmark&)>& workload,
+         const Params& params)
+{
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        std::cerr << "fork failed" << std::endl;
+        return false;
+    }
+
+    if (pid == 0)
+    {
+        int status = 0;
+        try
+        {
+            Benchmark b;
+            b.params = params;
+
+            // the reasoner reports e.g. the inference loops it removes on std::cout, which
+            // should neither be measured nor clutter the results
+            auto buffer = std::cout.rdbuf(nullptr);
+            try
+            {
+                workload(b);
+            }
+            catch (...)
+            {
+                std::cout.rdbuf(buffer);
+                throw;
+            }
+            std::cout.rdbuf(buffer);
+            std::cout.clear();
+            b.print(name);
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << name << " failed: " << e.what() << std::endl;
+            status = 1;
+        }
+        std::cout.flush();
+        _exit(status);
+    }
+
+    int status;
+    if (waitpid(pid, &status, 0) < 0) return false;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+void usage(const char* name)
+{
+    std::cout << "Usage: " << name << " [options] [workload...]\n"
+                 "Runs the given workloads, or all of them.\n\n"
+                 "Options:\n"
+                 "  --scale <f>     multiply the sizes of the workloads by f (default: 1)\n"
+                 "  --threads <n>   the number of threads of the reasoner (default: 1)\n"
+                 "  --seed <n>      the seed for the random parts of the workloads (default: 42)\n"
+                 "  --csv           print the results as csv\n"
+                 "  --list          list the workloads\n";
+}
+
+} /* anonymous namespace */
+
+
+int main(int argc, char** args)
+{
+    Params params;
+    std::vector<std::string> selected;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = args[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--scale" && hasValue) params.scale = std::atof(args[++i]);
+        else if (arg == "--threads" && hasValue) params.threads = std::atoi(args[++i]);
+        else if (arg == "--seed" && hasValue) params.seed = std::atoi(args[++i]);
+        else if (arg == "--csv") params.csv = true;
+        else if (arg == "--list")
+        {
+            for (auto& workload : workloads) std::cout << workload.first << std::endl;
+            return 0;
+        }
+        else if (arg.compare(0, 2, "--") == 0)
+        {
+            usage(args[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+        else
+        {
+            selected.push_back(arg);
+        }
+    }
+
+    if (params.scale <= 0 || params.threads < 1)
+    {
+        usage(args[0]);
+        return 1;
+    }
+
+    for (auto& name : selected)
+    {
+        auto it = std::find_if(workloads.begin(), workloads.end(),
+            [&name](const std::pair<std::string, std::function<void(Benchmark&)>>& w)
+            {
+                return w.first == name;
+            });
+        if (it == workloads.end())
+        {
+            std::cerr << "unknown workload: " << name << std::endl;
+            return 1;
+        }
+    }
+
+    printHeader(params);
+
+    bool success = true;
+    for (auto& workload : workloads)
+    {
+        if (!selected.empty() &&
+            std::find(selected.begin(), selected.end(), workload.first) == selected.end())
+        {
+            continue;
+        }
+        success = run(workload.first, workload.second, params) && success;
+    }
+
+    return success ? 0 : 1;
+}
@@ -59,14 +59,28 @@ public:
         token/wme are equal.
     */
     virtual bool valuesEqual(const InterpretationBase& other,
-                             Token::Ptr token,
-                             WME::Ptr wme) const = 0;
+                             const Token::Ptr& token,
+                             const WME::Ptr& wme) const = 0;
 
     /**
         Checks if the values accessed by this in two tokens are equal.
         (Note: Implemented specifically for GroupBy nodes)
     */
-    virtual bool valuesEqual(Token::Ptr t1, Token::Ptr t2) const = 0;
+    virtual bool valuesEqual(const Token::Ptr& t1, const Token::Ptr& t2) const = 0;
+
+    /**
+        Checks if the accessed values can be hashed, i.e. if there is a
+        std::hash<T> for the T in Interpretation<T>.
+    */
+    virtual bool isHashable() const = 0;
+
+    /**
+        Computes a hash of the value accessed in the given token/wme, selected
+        just like in valuesEqual. Values that are equal get the same hash, so
+        e.g. join nodes can use this to index their inputs on the join keys.
+        Throws a std::logic_error if the value type is not hashable.
+    */
+    virtual size_t hashValue(const Token::Ptr& token, const WME::Ptr& wme) const = 0;
 
     /**
         For debugging purposes: Returns a string describing the type of
@@ -321,19 +335,77 @@ public:
 */
 template <class T>
 class InterpretationImpl : public InterpretationBase {
+    /**
+        Implementation of hashValue, selected by whether T is hashable or not.
+    */
+    size_t hashValue(const Token::Ptr& token, const WME::Ptr& wme, std::true_type) const
+    {
+        const T* ref = getReference(token, wme);
+        if (ref) return std::hash<T>()(*ref);
+
+        T value;
+        getValue(token, wme, value);
+        return std::hash<T>()(value);
+    }
+
+    size_t hashValue(const Token::Ptr&, const WME::Ptr&, std::false_type) const
+    {
+        throw std::logic_error(
+                "Values of type " + internalTypeName() + " are not hashable");
+    }
+
+    /**
+        Selects the WME that getValue(token, wme, value) would extract the
+        value from, without copying any shared_ptr. Returns nullptr if the
+        token is too short.
+    */
+    const WME* selectWME(const Token::Ptr& token, const WME::Ptr& wme) const
+    {
+        int index = parent_->index();
+        if (index < 0) return wme.get();
+
+        Token* t = token->ancestor(index);
+        return t ? t->wme.get() : nullptr;
+    }
+
+    /**
+        Returns a pointer to the value inside of the selected WME, if the
+        accessor supports this (see referencer_), and nullptr else.
+    */
+    const T* getReference(const Token::Ptr& token, const WME::Ptr& wme) const
+    {
+        // the wmeModifier_ of TokenGroupAccessorForwarders creates new
+        // shared_ptr anyway, so don't bother with those.
+        if (!referencer_ || this->wmeModifier_) return nullptr;
+
+        const WME* w = selectWME(token, wme);
+        if (!w) return nullptr; // let getValue throw the error
+        return referencer_(*w);
+    }
+
 protected:
     std::function<void(WME::Ptr, T&)> extractor_;
 
+    /**
+        Optional. Returns a pointer to the value of type T that is stored
+        inside of the given WME, or nullptr if the value needs to be extracted
+        through the extractor_, e.g. because it must be converted first.
+        Allows comparisons without copying the values.
+    */
+    std::function<const T*(const WME&)> referencer_;
+
 public:
 
     /**
         A new instance of Interpretation must reference its parent-Accessor in
         order to get access to the index for the token to operate on, and also
         get a function to use in order to extract the value of type T from a
-        WME.
+        WME, and optionally a function that returns a pointer to the value
+        inside of the WME.
     */
-    InterpretationImpl(AccessorBase* p, std::function<void(WME::Ptr, T&)> extr)
-        : InterpretationBase(p), extractor_(extr)
+    InterpretationImpl(AccessorBase* p, std::function<void(WME::Ptr, T&)> extr,
+                       std::function<const T*(const WME&)> ref = nullptr)
+        : InterpretationBase(p), extractor_(extr), referencer_(ref)
     {
     }
 
@@ -389,21 +461,16 @@ public:
                     "Accessor constructed for WMEs only applied to a Token");
         }
 
-        while (count > 0 && token)
-        {
-            token = token->parent;
-            count--;
-        }
-
-        if (!token)
+        Token* t = token->ancestor(count);
+        if (!t)
         {
             throw std::out_of_range(
                     "Accessor indexes entry " + std::to_string(parent_->index())
-                    + " and the token is " + std::to_string(count+1)
-                    + " entries short on that.");
+                    + " and the token has only " + std::to_string(token->size())
+                    + " entries.");
         }
 
-        this->getValue(token->wme, value);
+        this->getValue(t->wme, value);
     }
 
 
@@ -427,14 +494,22 @@ public:
 
     bool valuesEqual(
                     const InterpretationBase& other,
-                    Token::Ptr token,
-                    WME::Ptr wme) const override
+                    const Token::Ptr& token,
+                    const WME::Ptr& wme) const override
     {
         // assume only those get compared who access the same type!
         assert(typeid(*this) == typeid(other));
 
         auto o = static_cast<const InterpretationImpl*>(&other);
 
+        // compare in place, if possible
+        const T* otherRef = o->getReference(token, wme);
+        if (otherRef)
+        {
+            const T* thisRef = this->getReference(token, wme);
+            if (thisRef) return *otherRef == *thisRef;
+        }
+
         T otherVal, thisVal;
         o->getValue(token, wme, otherVal);
         this->getValue(token, wme, thisVal);
@@ -442,8 +517,15 @@ public:
         return otherVal == thisVal;
     }
 
-    bool valuesEqual(Token::Ptr t1, Token::Ptr t2) const override
+    bool valuesEqual(const Token::Ptr& t1, const Token::Ptr& t2) const override
     {
+        const T* ref1 = getReference(t1, nullptr);
+        if (ref1)
+        {
+            const T* ref2 = getReference(t2, nullptr);
+            if (ref2) return *ref1 == *ref2;
+        }
+
         T val1, val2;
         getValue(t1, val1);
         getValue(t2, val2);
@@ -451,6 +533,16 @@ public:
         return val1 == val2;
     }
 
+    bool isHashable() const override
+    {
+        return util::is_hashable<T>::value;
+    }
+
+    size_t hashValue(const Token::Ptr& token, const WME::Ptr& wme) const override
+    {
+        return hashValue(token, wme, std::integral_constant<bool, util::is_hashable<T>::value>());
+    }
+
     std::string internalTypeName() const override
     {
         return util::beautified_typename<T>().value;
@@ -462,8 +554,9 @@ public:
 template <class T>
 class Interpretation : public InterpretationImpl<T> {
 public:
-    Interpretation(AccessorBase* p, std::function<void(WME::Ptr, T&)> extr)
-        : InterpretationImpl<T>(p, extr)
+    Interpretation(AccessorBase* p, std::function<void(WME::Ptr, T&)> extr,
+                   std::function<const T*(const WME&)> ref = nullptr)
+        : InterpretationImpl<T>(p, extr, ref)
     {
     }
 };
@@ -499,6 +592,13 @@ class Accessor<T, I> : public AccessorBase {
         getValue(specificWME, value);
     }
 
+    const I* getReferenceInternal(const WME& wme) const
+    {
+        const I* value = nullptr;
+        if (getReference(static_cast<const T&>(wme), value)) return value;
+        return nullptr;
+    }
+
 public:
     Accessor()
     {
@@ -509,12 +609,23 @@ public:
                 new Interpretation<I>(this,
                         std::bind(&Accessor::getValueInternal, this,
                             std::placeholders::_1,
-                            std::placeholders::_2))
+                            std::placeholders::_2),
+                        std::bind(&Accessor::getReferenceInternal, this,
+                            std::placeholders::_1))
                 });
     }
 
     virtual void getValue(std::shared_ptr<T>, I&) const = 0;
 
+    /**
+        Optionally, accessors can give direct access to a value of type I that
+        is stored inside the WME, so that joins can compare the values without
+        copying them. Returns false if not supported (the default).
+    */
+    virtual bool getReference(const T&, const I*&) const
+    {
+        return false;
+    }
 };
 
 
@@ -545,6 +656,13 @@ class Accessor : public Accessor<T, Is...> {
         getValue(specificWME, value);
     }
 
+    const I* getReferenceInternal(const WME& wme) const
+    {
+        const I* value = nullptr;
+        if (getReference(static_cast<const T&>(wme), value)) return value;
+        return nullptr;
+    }
+
 public:
     Accessor()
     {
@@ -555,16 +673,25 @@ public:
             new Interpretation<I>(this,
                     std::bind(&Accessor::getValueInternal, this,
                               std::placeholders::_1,
-                              std::placeholders::_2))
+                              std::placeholders::_2),
+                    std::bind(&Accessor::getReferenceInternal, this,
+                              std::placeholders::_1))
             });
     }
 
-    // pull getValue with different signatures from base classes to avoid
-    // "hidden overloaded virtual"
+    // pull getValue/getReference with different signatures from base classes
+    // to avoid "hidden overloaded virtual"
     using Accessor<T, Is...>::getValue;
+    using Accessor<T, Is...>::getReference;
 
     // force user to implement how to get data of type I from a WME of type T
     virtual void getValue(std::shared_ptr<T>, I&) const = 0;
+
+    // optional, see above
+    virtual bool getReference(const T&, const I*&) const
+    {
+        return false;
+    }
 };
 
 
@@ -2,56 +2,85 @@
 #include <stdexcept>
 
 #include "Agenda.hpp"
+#include "Util.hpp"
+#include "MemoryUsage.hpp"
 
 
 namespace rete {
 
-bool AgendaItemComparator::operator() (const AgendaItem& a, const AgendaItem& b) const
+size_t Agenda::bucketIndex(PropagationFlag flag)
 {
-    // need a strict ordering, where !(a < b) && !(b < a) if equiv. to a == b
-    // so a mere priority-comparison is not enough.
-    int prioA = std::get<1>(a)->getPriority();
-    int prioB = std::get<1>(b)->getPriority();
-
-    // if they differ, just use them:
-    if (prioA != prioB) return prioA > prioB;
-
-    // special treatment if priorities are equal:
-    // RETRACT before UPDATE before ASSERT:
-    PropagationFlag flagA = std::get<2>(a);
-    PropagationFlag flagB = std::get<2>(b);
-    if (flagA != flagB)
+    // RETRACT before UPDATE before ASSERT
+    switch (flag)
     {
-        switch(flagA)
-        {
-        case PropagationFlag::RETRACT:
-            return true;
-        case PropagationFlag::UPDATE:
-            return flagB == PropagationFlag::ASSERT;
-        case PropagationFlag::ASSERT:
-            return false;
-        }
+    case PropagationFlag::RETRACT:
+        return 0;
+    case PropagationFlag::UPDATE:
+        return 1;
+    case PropagationFlag::ASSERT:
+        return 2;
     }
+    return 2;
+}
+
+size_t Agenda::KeyHash::operator() (const Key& key) const
+{
+    size_t seed = std::hash<const Token*>()(key.first);
+    util::hash_combine(seed, std::hash<const Production*>()(key.second));
+    return seed;
+}
 
-    // if tokens differ, use them for the ordering
-    if (std::get<0>(a) != std::get<0>(b)) return std::get<0>(a) < std::get<0>(b); // just pointer comparison...
-    // NOTE: For comparison of tokens I only use pointer-comparison here. The assumption is that they will be different -- else the rete network is malformed and there are two equivalent BetaNodes.
+AgendaItem Agenda::toItem(const Entry& entry)
+{
+    return AgendaItem{std::get<0>(entry), std::get<1>(entry), std::get<2>(entry),
+                      *std::get<3>(entry)};
+}
 
-    // if tokens are the same, at least the production node might be different...
-    if (std::get<1>(a) != std::get<1>(b)) return std::get<1>(a) < std::get<1>(b);
-    // else... there is no difference. Pointer equality for both entries.
-    return false;
+const Agenda::Entry* Agenda::find(const Token::Ptr& token, const Production::Ptr& production) const
+{
+    auto it = index_.find(Key(token.get(), production.get()));
+    if (it == index_.end()) return nullptr;
+    return &*(it->second);
+}
+
+void Agenda::erase(const Token::Ptr& token, const Production::Ptr& production)
+{
+    auto it = index_.find(Key(token.get(), production.get()));
+    if (it == index_.end()) return;
+
+    auto item = it->second;
+    auto prio = queue_.find(std::get<1>(*item)->getPriority());
+    auto& bucket = prio->second[bucketIndex(std::get<2>(*item))];
+    bucket.erase(item);
+    index_.erase(it);
+
+    bool empty = true;
+    for (auto& b : prio->second) empty = empty && b.empty();
+    if (empty) queue_.erase(prio);
+}
+
+void Agenda::insert(Entry item)
+{
+    auto& bucket = queue_[std::get<1>(item)->getPriority()][bucketIndex(std::get<2>(item))];
+    Key key(std::get<0>(item).get(), std::get<1>(item).get());
+    bucket.push_back(std::move(item));
+    index_[key] = std::prev(bucket.end());
 }
 
 
 void Agenda::add(AgendaItem item)
 {
-    auto token = std::get<0>(item);
-    auto production = std::get<1>(item);
-    auto flag = std::get<2>(item);
-    auto name = std::get<3>(item);
+    add(std::move(std::get<0>(item)), std::move(std::get<1>(item)),
+        std::get<2>(item), std::make_shared<const std::string>(std::move(std::get<3>(item))));
+}
+
+void Agenda::add(Token::Ptr token, Production::Ptr production, PropagationFlag flag,
+                 std::shared_ptr<const std::string> name)
+{
+    // there is at most one item per token and production
+    auto existing = find(token, production);
+    PropagationFlag existingFlag = existing ? std::get<2>(*existing) : flag;
 
-    bool removed;
     switch (flag)
     {
     case rete::ASSERT:
@@ -59,7 +88,7 @@ void Agenda::add(AgendaItem item)
         // if there already is an update on the agenda, something is going clearly wrong!
         // this should never happen, and the check could be removed I guess, but just to be
         // sure lets throw an exception...
-        if (queue_.find(AgendaItem{token, production, rete::UPDATE, name}) != queue_.end())
+        if (existing && existingFlag == rete::UPDATE)
         {
             throw std::exception();
         }
@@ -79,29 +108,35 @@ void Agenda::add(AgendaItem item)
         // So, if a match is retracted and asserted again, both will remain on the agenda.
         // This is what the tradeof mentioned above is about -- loosing performance
         // optimization to fix a bug.
-        removed = remove(AgendaItem{token, production, rete::RETRACT, name});
-        if (removed) throw std::runtime_error("Agenda-Error: How could this happen? Tried to add ASSERT to the agenda for a match that is to be RETRACTED!");
+        if (existing && existingFlag == rete::RETRACT)
+        {
+            erase(token, production);
+            throw std::runtime_error("Agenda-Error: How could this happen? Tried to add ASSERT to the agenda for a match that is to be RETRACTED!");
+        }
 
-        // just add the ASSERT
-        queue_.insert(item);
+        // just add the ASSERT (if it is not already there)
+        if (!existing) insert(Entry{token, production, flag, name});
         break;
     case rete::RETRACT:
         // the same argumentation as above:
         // if there was an ASSERT scheduled, just dont do it.
         // if there was no ASSERT scheduled, explicitely RETRACT.
         // NOTE: Use remove because we are retracting an existing token, not adding a new one
-        removed = remove(AgendaItem{token, production, rete::ASSERT, name});
-        if (!removed)
+        if (existing && existingFlag == rete::ASSERT)
+        {
+            erase(token, production);
+        }
+        else if (!existing || existingFlag != rete::RETRACT)
         {
             // also, remove any already present UPDATEs
-            remove(AgendaItem{token, production, rete::UPDATE, name});
+            erase(token, production);
             // and insert the retract.
-            queue_.insert(item);
+            insert(Entry{token, production, flag, name});
         }
         break;
     case rete::UPDATE:
         // if there is an ASSERT for this token+production still on the agenda the update is unneccessary.
-        if (queue_.find(AgendaItem{token, production, rete::ASSERT, name}) != queue_.end())
+        if (existing && existingFlag == rete::ASSERT)
         {
             // so, no need to add the "update"
         }
@@ -109,18 +144,22 @@ void Agenda::add(AgendaItem item)
         {
             // is there a retract? why should there? if there is something is clearly wrong!
             // just for development/debugging make sure there isnt.
-            if (queue_.find(AgendaItem{token, production, rete::RETRACT, name}) != queue_.end())
+            if (existing && existingFlag == rete::RETRACT)
             {
                 throw std::exception();
             }
-            queue_.insert(item);
+            if (!existing) insert(Entry{token, production, flag, name});
         }
     }
 }
 
 bool Agenda::remove(AgendaItem item)
 {
-    return (queue_.erase(item) > 0);
+    auto existing = find(std::get<0>(item), std::get<1>(item));
+    if (!existing || std::get<2>(*existing) != std::get<2>(item)) return false;
+
+    erase(std::get<0>(item), std::get<1>(item));
+    return true;
 }
 
 bool Agenda::empty() const
@@ -130,12 +169,52 @@ bool Agenda::empty() const
 
 void Agenda::pop_front()
 {
-    queue_.erase(queue_.begin());
+    for (auto& bucket : queue_.begin()->second)
+    {
+        if (bucket.empty()) continue;
+
+        auto& item = bucket.front();
+        erase(std::get<0>(item), std::get<1>(item));
+        return;
+    }
 }
 
 AgendaItem Agenda::front() const
 {
-    return *(queue_.begin());
+    for (auto& bucket : queue_.begin()->second)
+    {
+        if (!bucket.empty()) return toItem(bucket.front());
+    }
+    throw std::exception(); // empty priorities are removed, so this cannot happen.
+}
+
+void Agenda::front(size_t count, std::vector<AgendaItem>& items) const
+{
+    for (auto& priority : queue_)
+    {
+        for (auto& bucket : priority.second)
+        {
+            for (auto& item : bucket)
+            {
+                if (count == 0) return;
+                items.push_back(toItem(item));
+                count--;
+            }
+        }
+    }
+}
+
+size_t Agenda::getMemoryUsage() const
+{
+    size_t bytes = util::memoryUsage(queue_) + util::memoryUsage(index_);
+    for (auto& entry : queue_)
+    {
+        for (auto& bucket : entry.second)
+        {
+            bytes += util::memoryUsage(bucket);
+        }
+    }
+    return bytes;
 }
 
 } /* rete */
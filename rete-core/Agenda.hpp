@@ -1,11 +1,15 @@
 #ifndef RETE_AGENDA_HPP_
 #define RETE_AGENDA_HPP_
 
-#include <queue>
 #include <vector>
-#include <set>
+#include <list>
+#include <map>
+#include <array>
+#include <unordered_map>
+#include <tuple>
 #include <utility>
 #include <string>
+#include <functional>
 
 
 #include "WME.hpp"
@@ -20,14 +24,6 @@ namespace rete {
 // token (data fulfilling conditions), production (what to do), flag (assert/retract), string (name of the rule that triggered this production, just cosmetics)
 typedef std::tuple<Token::Ptr, Production::Ptr, PropagationFlag, std::string> AgendaItem;
 
-/**
-    Implements comparison of AgendaItems based on the priority of their Production
-*/
-class AgendaItemComparator {
-public:
-    bool operator () (const AgendaItem&, const AgendaItem&) const;
-};
-
 
 /**
     The Agenda holds all matches for production nodes that were not yet processed, as well as
@@ -56,7 +52,50 @@ public:
 
 */
 class Agenda {
-    std::set<AgendaItem, AgendaItemComparator> queue_;
+    /**
+        The items as they are stored on the agenda: Instead of a copy of the rule name they
+        share the one of the ProductionNode, and are only converted to AgendaItems when they
+        are handed out.
+    */
+    typedef std::tuple<Token::Ptr, Production::Ptr, PropagationFlag,
+                       std::shared_ptr<const std::string>> Entry;
+    static AgendaItem toItem(const Entry&);
+
+    /**
+        Items with a higher priority are processed first. Within the same priority, RETRACTs come
+        before UPDATEs before ASSERTs, and items with the same flag are processed in the order they
+        were added. So there is a bucket (a FIFO-list) per priority and flag.
+    */
+    typedef std::array<std::list<Entry>, 3> Buckets;
+    std::map<int, Buckets, std::greater<int>> queue_;
+
+    static size_t bucketIndex(PropagationFlag);
+
+    /**
+        There is at most one item per token and production on the agenda (see above), and
+        it is indexed by the pair to find it without searching the buckets.
+    */
+    typedef std::pair<const Token*, const Production*> Key;
+    struct KeyHash {
+        size_t operator () (const Key&) const;
+    };
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+
+    /**
+        Returns the item for the given token and production, or nullptr
+    */
+    const Entry* find(const Token::Ptr&, const Production::Ptr&) const;
+
+    /**
+        Removes the item for the given token and production, if any
+    */
+    void erase(const Token::Ptr&, const Production::Ptr&);
+
+    /**
+        Appends the item to its bucket
+    */
+    void insert(Entry);
+
 public:
     using Ptr = std::shared_ptr<Agenda>;
 
@@ -65,6 +104,12 @@ public:
     */
     void add(AgendaItem);
 
+    /**
+        Same as above, without constructing an AgendaItem first. The name is shared with the
+        caller instead of copied.
+    */
+    void add(Token::Ptr, Production::Ptr, PropagationFlag, std::shared_ptr<const std::string> name);
+
     /**
         Remove an item from the agenda. Returns true if the AgendaItem was found and removed.
         This method requires the AgendaItem to match exactly, including the Token::Ptr.
@@ -88,6 +133,18 @@ public:
         Calling front() on an empty agenda is undefined.
     */
     AgendaItem front() const;
+
+    /**
+        Copies the first count items of the agenda, in the order they would be processed, to the
+        given vector. Copies less if the agenda does not contain that many items.
+    */
+    void front(size_t count, std::vector<AgendaItem>& items) const;
+
+    /**
+        Returns the approximate number of bytes allocated for the items on the agenda and
+        their index.
+    */
+    size_t getMemoryUsage() const;
 };
 
 } /* rete */
@@ -23,8 +23,10 @@ std::string AgendaNode::toString() const
 
 void AgendaNode::activate(Token::Ptr token, PropagationFlag flag)
 {
+    RETE_NODE_ACTIVATION(stats_, flag);
+
     // just add it to the agenda. All the special cases on when to really add it, remove other items etc, are all handled inside Agenda::add(AgendaItem)
-    agenda_->add(AgendaItem{token, production_, flag, getName()});
+    agenda_->add(token, production_, flag, name_);
 }
 
 } /* rete */
@@ -2,6 +2,7 @@
 #include "AlphaNode.hpp"
 #include "BetaComparator.hpp"
 #include "Util.hpp"
+#include "MemoryUsage.hpp"
 
 #include <algorithm>
 #include <iostream> // debug
@@ -59,7 +60,7 @@ void AlphaMemory::activate(WME::Ptr wme, PropagationFlag flag)
             // has been a match before --> UPDATE
             // NOTE: We do *not* propagate "wme" here, but "*it", because the
             // given "wme" might be a different instance that evaluates to the
-            // same *value* (see WMEComparator!), but holds the exact same
+            // same *value* (see WMEEqual!), but holds the exact same
             // mutable component that was added previously in another WME.
             // This might sound a bit complicated, so let me explain the exact
             // situation here:
@@ -76,7 +77,7 @@ void AlphaMemory::activate(WME::Ptr wme, PropagationFlag flag)
             //
             // It is already the case that the part of mutable wmes that is
             // considered in the by-value-comparison must be constant, or else
-            // it will mess up our std::set<WME::Ptr>. So the "by-value" can be
+            // it will mess up our std::unordered_set<WME::Ptr>. So the "by-value" can be
             // rather interpreted as "the data that is identified by this".
             //
             // But it is not completely irrelevant whether we use *it or wme,
@@ -93,6 +94,31 @@ void AlphaMemory::activate(WME::Ptr wme, PropagationFlag flag)
     }
 }
 
+void AlphaMemory::activateBatch(const std::vector<WME::Ptr>& wmes, PropagationFlag flag,
+                                size_t threads)
+{
+    if (flag != PropagationFlag::ASSERT)
+    {
+        for (auto& wme : wmes) activate(wme, flag);
+        return;
+    }
+
+    std::vector<WME::Ptr> inserted;
+    inserted.reserve(wmes.size());
+    for (auto& wme : wmes)
+    {
+        // only propagate what was actually inserted (no duplicates!)
+        if (wmes_.insert(wme).second) inserted.push_back(wme);
+    }
+    if (inserted.empty()) return;
+
+    for (auto child : children_)
+    {
+        auto c = child.lock();
+        if (c) c->rightActivateBatch(inserted, flag, threads);
+    }
+}
+
 void AlphaMemory::propagate(WME::Ptr wme, PropagationFlag flag)
 {
     for (auto child : children_)
@@ -177,12 +203,24 @@ void AlphaMemory::initialize()
         // remove all children -- only this memory node shall get the activations.
         std::vector<AlphaNode::WPtr> backup;
         backup.swap(parent_->children_);
+        parent_->childrenChanged();
 
         parent_->initialize();
 
         // reset children
         backup.swap(parent_->children_);
+        parent_->childrenChanged();
     }
 }
 
+size_t AlphaMemory::getMemoryUsage() const
+{
+    return util::memoryUsage(wmes_) + util::memoryUsage(children_);
+}
+
+std::shared_ptr<AlphaNode> AlphaMemory::getParent() const
+{
+    return parent_;
+}
+
 } /* rete */
@@ -2,7 +2,6 @@
 #define RETE_ALPHAMEMORY_HPP_
 
 #include <unordered_set>
-#include <set>
 #include <vector>
 
 #include "defs.hpp"
@@ -24,7 +23,7 @@ namespace rete {
     The AlphaMemory is created and used by AlphaNodes.
 */
 class AlphaMemory : public Node {
-    std::set<WME::Ptr, WMEComparator> wmes_;
+    std::unordered_set<WME::Ptr, WMEHash, WMEEqual> wmes_;
     std::vector<BetaNode::WPtr> children_;
     std::shared_ptr<AlphaNode> parent_;
 
@@ -41,7 +40,6 @@ protected:
     void propagate(WME::Ptr, PropagationFlag);
 
 public:
-    // using Container = std::unordered_set<WME::Ptr>;
     using Container = decltype(wmes_);
     using Iterator = Container::iterator;
     using Ptr = std::shared_ptr<AlphaMemory>;
@@ -60,6 +58,18 @@ public:
     size_t size() const;
     void activate(WME::Ptr, PropagationFlag);
 
+    /**
+        Adds a whole batch of WMEs, and right-activates every child once with all the WMEs that
+        were actually new. The children are processed one after the other in the same order as
+        in propagate, where descendants come before their ancestors: A token created by an
+        ancestor with one of the new WMEs reaches the descendant only after the descendant has
+        processed the whole batch, and is then joined with the memory that already contains it.
+        Hence every combination is created exactly once, just as if the WMEs had been added one
+        by one. Only ASSERTs are batched, other flags are processed one WME after the other.
+        The children may use up to the given number of threads to process the batch.
+    */
+    void activateBatch(const std::vector<WME::Ptr>&, PropagationFlag, size_t threads = 1);
+
 
     /**
         Get the list of children
@@ -87,6 +97,16 @@ public:
     void initialize() override;
 
     std::string toString() const override;
+
+    /**
+        The stored WMEs (only the pointers, see Node::getMemoryUsage()) and the children
+    */
+    size_t getMemoryUsage() const override;
+
+    /**
+        Get the parent alpha node
+    */
+    std::shared_ptr<AlphaNode> getParent() const;
 };
 
 } /* rete */
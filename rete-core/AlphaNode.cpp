@@ -1,11 +1,19 @@
 #include <algorithm>
+#include <exception>
+#include <thread>
 
 #include "AlphaNode.hpp"
 #include "AlphaMemory.hpp"
 #include "Util.hpp"
+#include "MemoryUsage.hpp"
 
 namespace rete {
 
+AlphaNode::AlphaNode()
+    : dispatchValid_(false)
+{
+}
+
 AlphaNode::~AlphaNode()
 {
     if (parent_) parent_->removeChild(this);
@@ -36,12 +44,14 @@ void AlphaNode::initialize()
                 }
             );
             parent_->children_.erase(newEnd, parent_->children_.end());
+            parent_->childrenChanged();
 
             // now initialize the parent
             parent_->initialize();
 
             // and undo the changes to its children.
             parent_->children_ = childrenBackup;
+            parent_->childrenChanged();
         }
     }
 }
@@ -56,6 +66,7 @@ std::string AlphaNode::toString() const
 void AlphaNode::addChild(AlphaNode::Ptr node)
 {
     children_.push_back(node);
+    childrenChanged();
 }
 
 void AlphaNode::removeChild(AlphaNode::WPtr node)
@@ -64,6 +75,7 @@ void AlphaNode::removeChild(AlphaNode::WPtr node)
         std::remove_if(children_.begin(), children_.end(), util::EqualWeak<AlphaNode>(node)),
         children_.end()
     );
+    childrenChanged();
 }
 
 void AlphaNode::removeChild(AlphaNode* node)
@@ -77,6 +89,63 @@ void AlphaNode::removeChild(AlphaNode* node)
             }),
         children_.end()
     );
+    childrenChanged();
+}
+
+void AlphaNode::childrenChanged()
+{
+    dispatchValid_ = false;
+}
+
+void AlphaNode::updateDispatch()
+{
+    undispatched_.clear();
+    dispatch_.clear();
+
+    for (auto child : children_)
+    {
+        auto c = child.lock();
+        if (!c) continue;
+
+        size_t group, key;
+        if (c->getDispatchGroup(group, key))
+        {
+            auto& g = dispatch_[group];
+            g.keyProvider = c;
+            g.children[key].push_back(c);
+        }
+        else
+        {
+            undispatched_.push_back(c);
+        }
+    }
+
+    // groups with a single child don't need the index
+    for (auto it = dispatch_.begin(); it != dispatch_.end();)
+    {
+        if (it->second.children.size() == 1 &&
+            it->second.children.begin()->second.size() == 1)
+        {
+            undispatched_.push_back(it->second.children.begin()->second[0]);
+            it = dispatch_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    dispatchValid_ = true;
+}
+
+bool AlphaNode::getDispatchGroup(size_t&, size_t&) const
+{
+    return false;
+}
+
+bool AlphaNode::getDispatchKey(WME::Ptr, size_t&) const
+{
+    return false;
 }
 
 
@@ -91,16 +160,151 @@ void AlphaNode::getChildren(std::vector<AlphaNode::Ptr>& children)
 }
 
 
-void AlphaNode::propagate(WME::Ptr wme, PropagationFlag flag)
+thread_local AlphaNode::Batch* AlphaNode::batch_ = nullptr;
+
+// chunks smaller than this are not worth a thread of their own
+static const size_t minWMEsPerThread = 1024;
+
+void AlphaNode::Batch::add(const AlphaMemory::Ptr& amem, const WME::Ptr& wme)
 {
+    auto pos = positions.find(amem.get());
+    if (pos == positions.end())
+    {
+        pos = positions.insert({amem.get(), memories.size()}).first;
+        memories.push_back({amem, {}});
+    }
+    memories[pos->second].second.push_back(wme);
+}
+
+void AlphaNode::Batch::append(Batch& other)
+{
+    for (auto& entry : other.memories)
+    {
+        auto pos = positions.find(entry.first.get());
+        if (pos == positions.end())
+        {
+            positions[entry.first.get()] = memories.size();
+            memories.push_back(std::move(entry));
+        }
+        else
+        {
+            auto& wmes = memories[pos->second].second;
+            wmes.insert(wmes.end(), entry.second.begin(), entry.second.end());
+        }
+    }
+}
+
+bool AlphaNode::prepareConcurrent()
+{
+    if (!isConcurrent()) return false;
+    if (!dispatchValid_) updateDispatch();
+
     for (auto child : children_)
     {
         auto c = child.lock();
-        if (c) c->activate(wme, flag);
+        if (c && !c->prepareConcurrent()) return false;
+    }
+    return true;
+}
+
+void AlphaNode::activateBatch(const std::vector<WME::Ptr>& wmes, PropagationFlag flag,
+                              size_t threads)
+{
+    if (flag != PropagationFlag::ASSERT || batch_)
+    {
+        for (auto& wme : wmes) activate(wme, flag);
+        return;
+    }
+
+    size_t chunks = std::min(threads, wmes.size() / minWMEsPerThread);
+    if (chunks < 1) chunks = 1;
+    if (chunks > 1 && !prepareConcurrent()) chunks = 1;
+
+    std::vector<Batch> batches(chunks);
+    std::vector<std::exception_ptr> errors(chunks);
+
+    auto classify = [&](size_t chunk)
+    {
+        batch_ = &batches[chunk];
+        try
+        {
+            size_t begin = wmes.size() * chunk / chunks;
+            size_t end = wmes.size() * (chunk + 1) / chunks;
+            for (size_t i = begin; i < end; i++)
+            {
+                activate(wmes[i], flag);
+            }
+        }
+        catch (...)
+        {
+            errors[chunk] = std::current_exception();
+        }
+        batch_ = nullptr;
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t chunk = 1; chunk < chunks; chunk++)
+    {
+        workers.emplace_back(classify, chunk);
+    }
+    classify(0);
+    for (auto& worker : workers) worker.join();
+
+    for (auto& error : errors)
+    {
+        if (error) std::rethrow_exception(error);
+    }
+
+    for (size_t chunk = 1; chunk < chunks; chunk++)
+    {
+        batches[0].append(batches[chunk]);
+    }
+
+    for (auto& entry : batches[0].memories)
+    {
+        entry.first->activateBatch(entry.second, flag, threads);
+    }
+}
+
+void AlphaNode::propagate(WME::Ptr wme, PropagationFlag flag)
+{
+    if (!dispatchValid_) updateDispatch();
+
+    for (auto child : undispatched_)
+    {
+        auto c = child.lock();
+        if (!c) continue;
+
+        RETE_NODE_ACTIVATION(c->stats_, flag);
+        c->activate(wme, flag);
+    }
+
+    for (auto& group : dispatch_)
+    {
+        auto provider = group.second.keyProvider.lock();
+        size_t key;
+        if (!provider || !provider->getDispatchKey(wme, key)) continue;
+
+        auto match = group.second.children.find(key);
+        if (match == group.second.children.end()) continue;
+
+        for (auto child : match->second)
+        {
+            auto c = child.lock();
+            if (!c) continue;
+
+            RETE_NODE_ACTIVATION(c->stats_, flag);
+            c->activate(wme, flag);
+        }
     }
 
     auto amem = amem_.lock();
-    if (amem) amem->activate(wme, flag);
+    if (!amem) return;
+
+    if (batch_ && flag == PropagationFlag::ASSERT)
+        batch_->add(amem, wme);
+    else
+        amem->activate(wme, flag);
 }
 
 
@@ -114,4 +318,25 @@ std::string AlphaNode::getDOTAttr() const
     return "[label=AlphaNode]";
 }
 
+AlphaNode::Ptr AlphaNode::getParent() const
+{
+    return parent_;
+}
+
+size_t AlphaNode::getMemoryUsage() const
+{
+    size_t bytes = util::memoryUsage(children_)
+                 + util::memoryUsage(undispatched_)
+                 + util::memoryUsage(dispatch_);
+    for (auto& group : dispatch_)
+    {
+        bytes += util::memoryUsage(group.second.children);
+        for (auto& children : group.second.children)
+        {
+            bytes += util::memoryUsage(children.second);
+        }
+    }
+    return bytes;
+}
+
 } /* rete */
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 #include "defs.hpp"
 #include "Node.hpp"
@@ -39,6 +40,16 @@ private:
     void removeChild(AlphaNode::WPtr);
     void removeChild(AlphaNode*);
 
+    /**
+        Marks the dispatch index as outdated. Must be called whenever children_ is modified.
+    */
+    void childrenChanged();
+
+    /**
+        Rebuilds the dispatch index from the current list of children.
+    */
+    void updateDispatch();
+
     /**
         Initialize this node. This will look at its parent: If the parent has an alpha-memory,
         it will process all the WMEs in there (again), as if they were just added. If the parent
@@ -53,6 +64,8 @@ private:
 
     inline void accept(NodeVisitor& visitor) override { visitor.visit(this); }
 public:
+    AlphaNode();
+
     /**
         Destructor, removes this node from its parent
     */
@@ -79,11 +92,46 @@ public:
     */
     virtual void activate(WME::Ptr, PropagationFlag) = 0;
 
+    /**
+        Activates the node with a whole batch of WMEs. Every WME is checked through activate as
+        usual, but the alpha memories are not activated once per WME: The WMEs are only
+        classified into buckets per alpha memory first, and every memory is then activated once
+        with its whole bucket, which lets the memories and joins process the batch at once, too.
+
+        If every node below this one isConcurrent, the classification of large batches is
+        split into chunks that are processed by the given number of threads.
+        The buckets of the chunks are merged in order, and the memories are activated on the
+        calling thread afterwards, so the result does not depend on the number of threads.
+        The threads may also be used by the joins below the memories, see
+        JoinNode::rightActivateBatch.
+
+        Only ASSERTs are batched, other flags are simply processed one WME after the other.
+    */
+    void activateBatch(const std::vector<WME::Ptr>&, PropagationFlag, size_t threads = 1);
+
+    /**
+        Returns true if activate(...) may be called on multiple threads at once, i.e., if the
+        node only checks the given WME and does not modify it or any other state. Custom nodes
+        are assumed not to be safe, so batches are only split across threads if all nodes of the
+        subtree override this.
+    */
+    virtual bool isConcurrent() const { return false; }
+
     /**
         Returns the AlphaMemory of this node, if it is set. Nullptr else.
     */
     AlphaMemory::Ptr getAlphaMemory() const;
 
+    /**
+        Get the parent alpha node, nullptr for the root of the network
+    */
+    AlphaNode::Ptr getParent() const;
+
+    /**
+        The children and the dispatch index
+    */
+    size_t getMemoryUsage() const override;
+
     /**
         It must be possible to test two AlphaNodes on equality, in order to reuse existing nodes
         whenever possible. This check does not need to take the complete network structure into
@@ -94,12 +142,38 @@ public:
     */
     virtual bool operator == (const AlphaNode& other) const = 0;
 
+    /**
+        Many AlphaNodes only check if a certain part of a WME equals a constant, and often a node
+        has lots of such children checking the same part for different constants (e.g. one
+        TripleAlpha per predicate used in the rules). Instead of activating all of them, the
+        parent can group these children in a hash map and activate only those whose constant
+        matches the WME.
+
+        To take part in this, return true and set the group, which identifies the part of the
+        WME that is checked (e.g. "the predicate of a triple"), and the key, which identifies the
+        constant. All nodes in a group must compute the same keys in getDispatchKey(WME::Ptr).
+
+        Since non-matching children are not activated at all -- also not on RETRACT and UPDATE --
+        this is only valid if the checked part of a WME never changes.
+
+        The default implementation returns false, so the node gets every WME.
+    */
+    virtual bool getDispatchGroup(size_t& group, size_t& key) const;
+
+    /**
+        Computes the key of the given WME for the dispatch group of this node. Returns false if
+        the WME cannot match any node of the group. Only called if getDispatchGroup returned true.
+    */
+    virtual bool getDispatchKey(WME::Ptr wme, size_t& key) const;
+
 
     std::string toString() const override;
 
 protected:
     /**
         Calls activate(wme) on all registered child nodes.
+        As activate is implemented by the derived classes, the activations of alpha nodes are
+        recorded in their statistics here.
     */
     void propagate(WME::Ptr, PropagationFlag);
 
@@ -107,6 +181,41 @@ private:
     AlphaMemory::WPtr amem_;
     AlphaNode::Ptr parent_;
     std::vector<AlphaNode::WPtr> children_;
+
+    /**
+        The children_, split into those that are always activated and those that are only
+        activated through the dispatch index. Groups with only a single child are not worth the
+        lookup and are activated directly, too.
+    */
+    struct DispatchGroup {
+        AlphaNode::WPtr keyProvider; // any node of the group, to compute the keys of WMEs
+        std::unordered_map<size_t, std::vector<AlphaNode::WPtr>> children;
+    };
+
+    bool dispatchValid_;
+    std::vector<AlphaNode::WPtr> undispatched_;
+    std::unordered_map<size_t, DispatchGroup> dispatch_;
+
+    /**
+        While a batch is classified, propagate does not activate the alpha memories but collects
+        the WMEs for them here, in the order the memories were first hit. Every thread that takes
+        part in the classification has its own.
+    */
+    struct Batch {
+        std::vector<std::pair<AlphaMemory::Ptr, std::vector<WME::Ptr>>> memories;
+        std::unordered_map<const AlphaMemory*, size_t> positions;
+
+        void add(const AlphaMemory::Ptr&, const WME::Ptr&);
+        void append(Batch& other);
+    };
+    static thread_local Batch* batch_;
+
+    /**
+        Builds the dispatch indexes of this node and all its descendants, so that they are not
+        modified while multiple threads classify WMEs. Returns false (and stops early) if any of
+        the nodes is not isConcurrent.
+    */
+    bool prepareConcurrent();
 };
 
 } /* rete */
@@ -41,14 +41,15 @@ class BetaBetaNode : public BetaNode {
 
     std::string getDOTAttr() const override;
 
+    inline void accept(NodeVisitor& visitor) override { visitor.visit(this); }
+protected:
     /**
         Will call leftActivate on all the contents of the left parent memory.
         It is assumed that the node will check the contents of the right parent
         memory on its own for every of these calls.
     */
     void initialize() override;
-    inline void accept(NodeVisitor& visitor) override { visitor.visit(this); }
-protected:
+
     // left and right BetaMemory-parent.
     // parentAlpha_ and parentBeta_ from BetaNode are left unused.
     BetaMemory::Ptr parentRight_, parentLeft_;
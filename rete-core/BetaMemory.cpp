@@ -2,6 +2,7 @@
 #include "BetaNode.hpp"
 #include "ProductionNode.hpp"
 #include "Util.hpp"
+#include "MemoryUsage.hpp"
 
 #include <algorithm>
 #include <iostream>
@@ -19,15 +20,102 @@ void BetaMemory::initialize()
     if (parent_) parent_->initialize();
 }
 
+void BetaMemory::add(Token::Ptr token)
+{
+    auto& siblings = byParent_[token->parent.get()];
+    auto& sameWME = byWME_[token->wme.get()];
+
+    Position pos;
+    pos.token = tokens_.size();
+    pos.parentGroup = siblings.size();
+    pos.wmeGroup = sameWME.size();
+    positions_[token.get()] = pos;
+
+    tokens_.push_back(token);
+    siblings.push_back(token);
+    sameWME.push_back(token);
+}
+
+void BetaMemory::remove(Token::Ptr token)
+{
+    auto it = positions_.find(token.get());
+    if (it == positions_.end()) return;
+
+    Position pos = it->second;
+    positions_.erase(it);
+
+    // replace the token with the last entry, update the position of the moved one.
+    if (pos.token + 1 != tokens_.size())
+    {
+        tokens_[pos.token] = tokens_.back();
+        positions_[tokens_[pos.token].get()].token = pos.token;
+    }
+    tokens_.pop_back();
+
+    // same for the groups
+    auto siblingsIt = byParent_.find(token->parent.get());
+    auto& siblings = siblingsIt->second;
+    if (pos.parentGroup + 1 != siblings.size())
+    {
+        siblings[pos.parentGroup] = siblings.back();
+        positions_[siblings[pos.parentGroup].get()].parentGroup = pos.parentGroup;
+    }
+    siblings.pop_back();
+    if (siblings.empty()) byParent_.erase(siblingsIt);
+
+    auto sameWMEIt = byWME_.find(token->wme.get());
+    auto& sameWME = sameWMEIt->second;
+    if (pos.wmeGroup + 1 != sameWME.size())
+    {
+        sameWME[pos.wmeGroup] = sameWME.back();
+        positions_[sameWME[pos.wmeGroup].get()].wmeGroup = pos.wmeGroup;
+    }
+    sameWME.pop_back();
+    if (sameWME.empty()) byWME_.erase(sameWMEIt);
+}
+
+void BetaMemory::clear()
+{
+    tokens_.clear();
+    positions_.clear();
+    byParent_.clear();
+    byWME_.clear();
+}
+
+void BetaMemory::find(Token::Ptr t, WME::Ptr wme, std::vector<Token::Ptr>& result) const
+{
+    if (t)
+    {
+        auto siblings = byParent_.find(t.get());
+        if (siblings == byParent_.end()) return;
+
+        for (auto& mt : siblings->second)
+        {
+            if (!wme || *mt->wme == *wme) // compare by value!
+            {
+                result.push_back(mt);
+            }
+        }
+    }
+    else if (wme)
+    {
+        auto sameWME = byWME_.find(wme.get());
+        if (sameWME == byWME_.end()) return;
+
+        result.insert(result.end(), sameWME->second.begin(), sameWME->second.end());
+    }
+}
+
 void BetaMemory::leftActivate(Token::Ptr t, WME::Ptr wme, PropagationFlag flag)
 {
+    RETE_NODE_ACTIVATION(stats_, flag);
+
     if (flag == PropagationFlag::ASSERT)
     {
-        Token::Ptr tNew(new Token());
-        tNew->parent = t;
-        tNew->wme = wme;
+        Token::Ptr tNew = Token::create(t, wme);
 
-        tokens_.push_back(tNew);
+        add(tNew);
+        RETE_NODE_STATS(stats_.created());
 
         for (auto child : children_)
         {
@@ -47,27 +135,18 @@ void BetaMemory::leftActivate(Token::Ptr t, WME::Ptr wme, PropagationFlag flag)
             When a beta memory is left-activated for removal, different things may be the case:
                 1. Only the token is given, and wme is nullptr, because the given token has been removed by the parent node --> remove all token which have this token as a parent
                 2. Only the wme is given, because the parent node was an AlphaBetaAdapter. Remove all tokens whose head is the wme
-                3. Both token and wme are given --  This happens when the parent beta node got an UPDATE and re-evaluates all combinations (in case of a join), explicitely retracting not-matching combinations as it does not know if it was a match before. Well, the BetaMemory does know, checks all tokens [*] and removes only those which actually existed before.
+                3. Both token and wme are given --  This happens when the parent beta node got an UPDATE and re-evaluates all combinations (in case of a join), explicitely retracting not-matching combinations as it does not know if it was a match before. Well, the BetaMemory does know, checks the tokens with the given parent and removes only those which actually existed before.
                 4. None are given -- TODO what to do?
-
-                [*] TODO: Maybe some kind of index would be nice?
         */
         if (!t && !wme) throw std::exception(); // not implemented. case 4
 
         std::vector<Token::Ptr> toRemove;
-        for (auto mt : tokens_)
-        {
-            if ((!t || mt->parent == t) &&    // if t is given it must match
-                (!wme || *mt->wme == *wme))   // if wme is given it must match (compare by value!)
-            {
-                toRemove.push_back(mt);
-            }
-        }
+        find(t, wme, toRemove);
+        RETE_NODE_STATS(stats_.retracted(toRemove.size()));
 
         for (auto mt : toRemove)
         {
-            auto it = std::remove(tokens_.begin(), tokens_.end(), mt);
-            tokens_.erase(it);
+            remove(mt);
 
             for (auto child : children_)
             {
@@ -106,27 +185,30 @@ void BetaMemory::leftActivate(Token::Ptr t, WME::Ptr wme, PropagationFlag flag)
         // always have a non-computed WME. Right?
         if (wme->isComputed())
         {
-            for (auto mt : tokens_)
+            std::vector<Token::Ptr> matching;
+            find(t, nullptr, matching);
+            if (!matching.empty())
             {
-                if (mt->parent == t)
+                // got it! update the computation, propagate an update.
+                // (re-add to keep the index on the wmes consistent)
+                auto mt = matching.front();
+                remove(mt);
+                mt->wme = wme;
+                add(mt);
+
+                for (auto child : children_)
                 {
-                    // got it! update the computation, propagate an update.
-                    mt->wme = wme;
-
-                    for (auto child : children_)
-                    {
-                        auto c = child.lock();
-                        if (c) c->leftActivate(mt, PropagationFlag::UPDATE);
-                    }
-                    for (auto production : productions_)
-                    {
-                        auto p = production.lock();
-                        if (p) p->activate(mt, PropagationFlag::UPDATE);
-                    }
-
-                    // nothing more to do, only needed to find the first entry.
-                    return;
+                    auto c = child.lock();
+                    if (c) c->leftActivate(mt, PropagationFlag::UPDATE);
                 }
+                for (auto production : productions_)
+                {
+                    auto p = production.lock();
+                    if (p) p->activate(mt, PropagationFlag::UPDATE);
+                }
+
+                // nothing more to do, only needed to find the first entry.
+                return;
             }
 
             // couldn't find it, so its new. A new match *because* it changed (and didn't match
@@ -137,11 +219,13 @@ void BetaMemory::leftActivate(Token::Ptr t, WME::Ptr wme, PropagationFlag flag)
         else
         {
             // the wme is not computed, so we actually search for an entry where token and wme match
-            for (auto mt : tokens_)
+            std::vector<Token::Ptr> matching;
+            find(nullptr, wme, matching);
+            for (auto mt : matching)
             {
                 // TODO: Compare wme by value? Not neccessary, I guess... Since it is an UPDATE the
                 // wme *instance* should be known.
-                if (mt->parent == t && mt->wme == wme)
+                if (mt->parent == t)
                 {
                     // got it! propagate an update.
                     for (auto child : children_)
@@ -171,16 +255,15 @@ void BetaMemory::leftActivate(Token::Ptr t, WME::Ptr wme, PropagationFlag flag)
 
 void BetaMemory::rightRemoval(WME::Ptr wme)
 {
+    RETE_NODE_ACTIVATION(stats_, PropagationFlag::RETRACT);
+
     std::vector<Token::Ptr> toRemove;
-    for (auto t : tokens_)
-    {
-        if (*t->wme == *wme) toRemove.push_back(t);
-    }
+    find(nullptr, wme, toRemove);
+    RETE_NODE_STATS(stats_.retracted(toRemove.size()));
 
     for (auto t : toRemove)
     {
-        auto it = std::remove(tokens_.begin(), tokens_.end(), t);
-        tokens_.erase(it);
+        remove(t);
 
         for (auto child : children_)
         {
@@ -277,6 +360,14 @@ size_t BetaMemory::size() const
     return tokens_.size();
 }
 
+Token::Ptr BetaMemory::get(const Token* token) const
+{
+    auto it = positions_.find(token);
+    if (it == positions_.end()) return nullptr;
+
+    return tokens_[it->second.token];
+}
+
 BetaMemory::Iterator BetaMemory::begin()
 {
     return tokens_.begin();
@@ -297,4 +388,25 @@ std::string BetaMemory::getDOTAttr() const
     return "[shape=record, label=\"{BetaMemory" + record + "}\"]";
 }
 
+BetaNodePtr BetaMemory::getParent() const
+{
+    return parent_;
+}
+
+size_t BetaMemory::getMemoryUsage() const
+{
+    // Every token is stored in exactly one memory, so they are counted here. (Without the arrays
+    // of their ancestors, which are mostly shared between the tokens.)
+    size_t bytes = tokens_.size() * util::sharedMemoryUsage<Token>()
+                 + util::memoryUsage(tokens_)
+                 + util::memoryUsage(positions_)
+                 + util::memoryUsage(byParent_)
+                 + util::memoryUsage(byWME_)
+                 + util::memoryUsage(children_)
+                 + util::memoryUsage(productions_);
+    for (auto& group : byParent_) bytes += util::memoryUsage(group.second);
+    for (auto& group : byWME_) bytes += util::memoryUsage(group.second);
+    return bytes;
+}
+
 } /* rete */
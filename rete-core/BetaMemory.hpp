@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 // #include "BetaNode.hpp"
 #include "defs.hpp"
@@ -31,6 +32,45 @@ namespace rete {
 */
 class BetaMemory : public Node {
     std::vector<Token::Ptr> tokens_;
+
+    /**
+        To find the tokens affected by a retraction or update without scanning the whole memory,
+        the tokens are additionally grouped by their parent token and by (the instance of) their
+        wme. The positions of every token in tokens_ and in its groups are remembered, which allows
+        to remove a token from all of them in O(1) by swapping it with the last entry. Hence, the
+        order of the tokens is not preserved.
+    */
+    struct Position {
+        size_t token;
+        size_t parentGroup;
+        size_t wmeGroup;
+    };
+    std::unordered_map<const Token*, Position> positions_;
+    std::unordered_map<const Token*, std::vector<Token::Ptr>> byParent_;
+    std::unordered_map<const WME*, std::vector<Token::Ptr>> byWME_;
+
+    /**
+        Adds the token to tokens_ and the indexes
+    */
+    void add(Token::Ptr);
+
+    /**
+        Removes the token from tokens_ and the indexes
+    */
+    void remove(Token::Ptr);
+
+    /**
+        Removes all tokens (without retracting them!)
+    */
+    void clear();
+
+    /**
+        Collects the stored tokens with the given parent and wme. If the parent is given, the wme
+        is compared by value, else only the tokens with exactly this wme instance are returned.
+        A nullptr matches every parent/wme, but not both may be nullptr.
+    */
+    void find(Token::Ptr parent, WME::Ptr wme, std::vector<Token::Ptr>& result) const;
+
     std::vector<BetaNodeWPtr> children_;
     std::vector<ProductionNodeWPtr> productions_;
     BetaNodePtr parent_;
@@ -92,7 +132,9 @@ public:
 
     /**
         BetaMemories also need to react when a BetaNode is right-activated for removal of an WME!
-        Remove all Tokens with token.wme == wme
+        Remove all Tokens with token.wme == wme.
+        Note: The WME is identified by instance here. This is fine as the alpha memories always
+        propagate the instance they stored, not an equal one.
     */
     void rightRemoval(WME::Ptr);
 
@@ -101,6 +143,22 @@ public:
 
     size_t size() const;
 
+    /**
+        Returns the stored pointer to exactly this token instance, or nullptr
+        if it is not in the memory.
+    */
+    Token::Ptr get(const Token*) const;
+
+    /**
+        Get the parent beta node
+    */
+    BetaNodePtr getParent() const;
+
+    /**
+        The stored tokens, including the tokens themselves, and the indexes
+    */
+    size_t getMemoryUsage() const override;
+
     Iterator begin();
     Iterator end();
 
@@ -32,6 +32,15 @@ void BetaNode::initialize()
     }
 }
 
+void BetaNode::rightActivateBatch(const std::vector<WME::Ptr>& wmes, PropagationFlag flag,
+                                  size_t)
+{
+    for (auto& wme : wmes)
+    {
+        rightActivate(wme, flag);
+    }
+}
+
 BetaMemory::Ptr BetaNode::getParentBeta() const
 {
     return parentBeta_;
@@ -2,6 +2,7 @@
 #define RETE_BETA_NODE_HPP_
 
 #include <memory>
+#include <vector>
 
 #include "defs.hpp"
 #include "Node.hpp"
@@ -24,6 +25,8 @@ class BetaNode : public Node {
     friend class BetaMemory;
     std::string getDOTAttr() const override;
 
+    inline void accept(NodeVisitor& visitor) override { visitor.visit(this); }
+protected:
     /**
         Initializes this node. Basically a helper for recursive initialization of the child beta
         memory. Iterates over the contents of its parent memory and call left- or rightActivate
@@ -31,8 +34,7 @@ class BetaNode : public Node {
         it only iterates over the left parent.
     */
     void initialize() override;
-    inline void accept(NodeVisitor& visitor) override { visitor.visit(this); }
-protected:
+
     AlphaMemoryPtr parentAlpha_;
     BetaMemory::Ptr parentBeta_;
     BetaMemory::WPtr bmem_;
@@ -55,6 +57,16 @@ public:
     */
     virtual void rightActivate(WME::Ptr, PropagationFlag) = 0;
 
+    /**
+        Called with a whole batch of WMEs that were added to the connected AlphaMemory at once.
+        The default implementation right-activates the node once per WME. Override it if the node
+        can process the batch more efficiently, e.g. by scanning its beta memory only once.
+        The node may use up to the given number of threads to do so, but must activate its beta
+        memory only on the calling thread.
+    */
+    virtual void rightActivateBatch(const std::vector<WME::Ptr>&, PropagationFlag,
+                                    size_t threads);
+
     /**
         Called upon changes in the connected BetaMemory.
     */
@@ -39,6 +39,7 @@ void Builtin::rightActivate(WME::Ptr, PropagationFlag)
 
 void Builtin::leftActivate(Token::Ptr token, PropagationFlag flag)
 {
+    RETE_NODE_ACTIVATION(stats_, flag);
     auto bmem = bmem_.lock();
     if (!bmem) throw std::exception(); // no memory to forward anything to. Should not be possible.
 
@@ -51,6 +52,7 @@ void Builtin::leftActivate(Token::Ptr token, PropagationFlag flag)
     {
         // process the submatch
         auto computed = process(token);
+        RETE_NODE_STATS(stats_.checked(computed != nullptr));
 
         if (computed)
         {
@@ -69,6 +71,7 @@ void Builtin::leftActivate(Token::Ptr token, PropagationFlag flag)
         // if it actually is an UPDATE, a new match (ASSERT), a no longer match (RETRACT), or if it
         // didnt match before and still doesnt.
         auto computed = process(token);
+        RETE_NODE_STATS(stats_.checked(computed != nullptr));
 
         if (computed)
         {
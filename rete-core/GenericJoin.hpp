@@ -27,7 +27,7 @@ class GenericJoin : public JoinNode {
     {
         std::string s = std::string("[label=\"") +
                                 (isNegative() ? "negative " : "") + "GenericJoin";
-        for (auto check : checks_)
+        for (auto& check : checks_)
         {
             s = s + "\\n" +
                 util::dotEscape(check.leftAccessor->toString()) + " == " +
@@ -44,7 +44,7 @@ class GenericJoin : public JoinNode {
         std::string s = "GenericJoin";
         if (isNegative()) s = "negative " + s;
 
-        for (auto check : checks_)
+        for (auto& check : checks_)
         {
             s = s + "\n" + check.leftAccessor->toString() + " == " +
                            check.rightAccessor->toString() +
@@ -65,8 +65,46 @@ class GenericJoin : public JoinNode {
     };
     std::vector<Check> checks_;
 
+    /**
+        True if all checks compare hashable values, which allows the JoinNode to use hash indexes
+        on the join keys instead of checking every combination of token and wme.
+    */
+    bool indexable_;
+
+protected:
+    bool isIndexable() const override
+    {
+        return indexable_;
+    }
+
+    size_t leftKey(Token::Ptr token) const override
+    {
+        size_t key = 0;
+        for (auto& check : checks_)
+        {
+            util::hash_combine(key, check.common.first->hashValue(token, nullptr));
+        }
+        return key;
+    }
+
+    size_t rightKey(WME::Ptr wme) const override
+    {
+        size_t key = 0;
+        for (auto& check : checks_)
+        {
+            util::hash_combine(key, check.common.second->hashValue(nullptr, wme));
+        }
+        return key;
+    }
+
 public:
     using Ptr = std::shared_ptr<GenericJoin>;
+
+    GenericJoin()
+        : indexable_(false)
+    {
+    }
+
     /**
         Adds an additional check to the join node.
         The left accessor will be applied to a token, while the right accessor is directly used
@@ -93,12 +131,18 @@ public:
             c.rightAccessor = right;
             c.common = pair;
             checks_.push_back(c);
+
+            indexable_ = std::all_of(checks_.begin(), checks_.end(),
+                            [](const Check& check) -> bool
+                            {
+                                return check.common.first->isHashable();
+                            });
         }
     }
 
-    bool isValidCombination(Token::Ptr token, WME::Ptr wme) override
+    bool isValidCombination(const Token::Ptr& token, const WME::Ptr& wme) override
     {
-        for (auto check : checks_)
+        for (auto& check : checks_)
         {
             if (!check.common.first->valuesEqual(*check.common.second, token, wme))
             {
@@ -108,16 +152,22 @@ public:
         return true;
     }
 
+    bool isConcurrent() const override
+    {
+        // the checks only read the token and wme
+        return true;
+    }
+
     bool operator == (const BetaNode& other) const override
     {
         if (auto o = dynamic_cast<const GenericJoin*>(&other))
         {
             if (o->isNegative() != this->isNegative()) return false;
             if (o->checks_.size() != this->checks_.size()) return false;
-            for (auto check : this->checks_)
+            for (auto& check : this->checks_)
             {
                 if (std::find_if(o->checks_.begin(), o->checks_.end(),
-                        [check](const Check& other) -> bool
+                        [&check](const Check& other) -> bool
                         {
                             return (*other.leftAccessor == *check.leftAccessor) &&
                                    (*other.rightAccessor == *check.rightAccessor);
@@ -1,11 +1,16 @@
 #include <algorithm>
 
 #include "GroupBy.hpp"
+#include "MemoryUsage.hpp"
 
 namespace rete {
 
 void GroupBy::addCriteria(std::unique_ptr<AccessorBase>&& acc)
 {
+    auto interpretation = acc->getCommonInterpretation(*acc).first;
+    if (!interpretation) throw std::exception();
+
+    interpretations_.push_back(interpretation);
     accessors_.push_back(std::move(acc));
 }
 
@@ -50,6 +55,7 @@ void GroupBy::rightActivate(WME::Ptr, PropagationFlag)
 
 void GroupBy::leftActivate(Token::Ptr token, PropagationFlag flag)
 {
+    RETE_NODE_ACTIVATION(stats_, flag);
     auto bmem = bmem_.lock();
     if (!bmem) throw std::exception();
 
@@ -63,11 +69,12 @@ void GroupBy::leftActivate(Token::Ptr token, PropagationFlag flag)
         // - else
         //      - add to group
         //      - publish UPDATE for group
-        auto group = findMatchingGroup(token);
+        size_t key = groupKey(token);
+        auto group = findMatchingGroup(token, key);
         if (!group)
         {
             group = std::make_shared<TokenGroup>();
-            groups_.insert(group);
+            insertGroup(key, group);
             addToGroup(token, group);
             bmem->leftActivate(nullptr, group, PropagationFlag::ASSERT);
         }
@@ -92,7 +99,7 @@ void GroupBy::leftActivate(Token::Ptr token, PropagationFlag flag)
         removeFromGroup(token, group);
         if (group->token_.empty())
         {
-            groups_.erase(group);
+            eraseGroup(group);
             bmem->leftActivate(nullptr, group, PropagationFlag::RETRACT);
         }
         else
@@ -112,8 +119,30 @@ void GroupBy::leftActivate(Token::Ptr token, PropagationFlag flag)
         //      - publish UPDATE for group
         //      - handle as a new match
         auto group = findTokenGroupContainingToken(token);
-        if (fitsInGroup(token, group))
+        size_t key = groupKey(token);
+
+        // a token that is alone in its group always fits, but there might be
+        // another group with its new values already
+        auto other = (group->token_.size() == 1 ? findMatchingGroup(token, key, group) : nullptr);
+        if (other)
+        {
+            removeFromGroup(token, group);
+            eraseGroup(group);
+            bmem->leftActivate(nullptr, group, PropagationFlag::RETRACT);
+
+            addToGroup(token, other);
+            bmem->leftActivate(nullptr, other, PropagationFlag::UPDATE);
+        }
+        else if (fitsInGroup(token, group))
         {
+            // the values of the whole group might have changed, so keep it
+            // indexed by the current ones.
+            if (keyOfGroup_[group.get()] != key)
+            {
+                eraseGroup(group);
+                insertGroup(key, group);
+            }
+            group->update(token);
             bmem->leftActivate(nullptr, group, PropagationFlag::UPDATE);
         }
         else
@@ -137,26 +166,63 @@ TokenGroup::Ptr GroupBy::findTokenGroupContainingToken(Token::Ptr token) const
 
 void GroupBy::addToGroup(Token::Ptr token, TokenGroup::Ptr group)
 {
-    group->token_.insert(token);
+    group->insert(token);
     groupOfToken_[token] = group;
 }
 
 void GroupBy::removeFromGroup(Token::Ptr token, TokenGroup::Ptr group)
 {
-    group->token_.erase(token);
+    group->erase(token);
     groupOfToken_.erase(token);
 }
 
 
+size_t GroupBy::groupKey(const Token::Ptr& token) const
+{
+    size_t key = 0;
+    for (auto interpretation : interpretations_)
+    {
+        // values that cannot be hashed all count as 0, their groups are
+        // only told apart by fitsInGroup.
+        size_t hash = 0;
+        if (interpretation->isHashable()) hash = interpretation->hashValue(token, nullptr);
+        util::hash_combine(key, hash);
+    }
+    return key;
+}
+
+void GroupBy::insertGroup(size_t key, TokenGroup::Ptr group)
+{
+    keyOfGroup_[group.get()] = key;
+    groups_.insert({key, group});
+}
+
+void GroupBy::eraseGroup(const TokenGroup::Ptr& group)
+{
+    auto it = keyOfGroup_.find(group.get());
+    if (it == keyOfGroup_.end()) return;
+
+    auto range = groups_.equal_range(it->second);
+    for (auto g = range.first; g != range.second; ++g)
+    {
+        if (g->second == group)
+        {
+            groups_.erase(g);
+            break;
+        }
+    }
+    keyOfGroup_.erase(it);
+}
+
+
 bool GroupBy::fitsInGroup(Token::Ptr token, TokenGroup::Ptr group) const
 {
     for (auto other : group->token_)
     {
         if (token == other) continue;
 
-        for (auto& acc : accessors_)
+        for (auto interpretation : interpretations_)
         {
-            auto interpretation = acc->getCommonInterpretation(*acc).first;
             if (!interpretation->valuesEqual(token, other))
             {
                 return false;
@@ -171,14 +237,30 @@ bool GroupBy::fitsInGroup(Token::Ptr token, TokenGroup::Ptr group) const
 }
 
 
-TokenGroup::Ptr GroupBy::findMatchingGroup(Token::Ptr token) const
+TokenGroup::Ptr GroupBy::findMatchingGroup(Token::Ptr token, size_t key,
+                                           const TokenGroup::Ptr& except) const
 {
-    for (auto group : groups_)
+    auto range = groups_.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it)
     {
-        if (fitsInGroup(token, group)) return group;
+        if (it->second == except) continue;
+        if (fitsInGroup(token, it->second)) return it->second;
     }
     return nullptr;
 }
 
 
+size_t GroupBy::getMemoryUsage() const
+{
+    size_t bytes = util::memoryUsage(groups_)
+                 + util::memoryUsage(keyOfGroup_)
+                 + util::memoryUsage(tokenOfGroup_)
+                 + util::memoryUsage(groupOfToken_);
+    for (auto& entry : groups_)
+    {
+        bytes += util::sharedMemoryUsage<TokenGroup>() + entry.second->getMemoryUsage();
+    }
+    return bytes;
+}
+
 }
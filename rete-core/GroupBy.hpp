@@ -3,6 +3,7 @@
 
 #include <set>
 #include <map>
+#include <unordered_map>
 
 #include "BetaNode.hpp"
 #include "TokenGroup.hpp"
@@ -19,9 +20,15 @@ namespace rete {
 */
 class GroupBy : public BetaNode {
     /**
-        The actual groups
+        The actual groups, indexed by a hash over the values of the criteria
+        of their tokens. Groups with the same key are still compared by value,
+        as different values may hash equally (and values that are not
+        hashable at all are all hashed as 0).
+        As the tokens of a group share the same values, the key of a group is
+        the key of any of its tokens.
     */
-    std::set<TokenGroup::Ptr> groups_;
+    std::unordered_multimap<size_t, TokenGroup::Ptr> groups_;
+    std::unordered_map<const TokenGroup*, size_t> keyOfGroup_;
 
     /**
         When groups are inferred they need to be added to a token.
@@ -32,12 +39,26 @@ class GroupBy : public BetaNode {
     /**
         Index in which group the given token was added
     */
-    std::map<Token::Ptr, TokenGroup::Ptr> groupOfToken_;
+    std::unordered_map<Token::Ptr, TokenGroup::Ptr> groupOfToken_;
 
     /**
-        Criteria for adding a token to a group.
+        Criteria for adding a token to a group, and the interpretations
+        through which their values are compared, resolved once in
+        addCriteria.
     */
     std::vector<std::unique_ptr<AccessorBase>> accessors_;
+    std::vector<InterpretationBase*> interpretations_;
+
+    /**
+        Computes the hash over the values of all criteria for the given token
+    */
+    size_t groupKey(const Token::Ptr&) const;
+
+    /**
+        Adds/removes a group to/from the index
+    */
+    void insertGroup(size_t key, TokenGroup::Ptr);
+    void eraseGroup(const TokenGroup::Ptr&);
 
 
     /**
@@ -62,9 +83,11 @@ class GroupBy : public BetaNode {
     void removeFromGroup(Token::Ptr, TokenGroup::Ptr);
 
     /**
-        Finds a group in which the given token would fit
+        Finds a group with the given key in which the given token would fit,
+        other than the given one
     */
-    TokenGroup::Ptr findMatchingGroup(Token::Ptr) const;
+    TokenGroup::Ptr findMatchingGroup(Token::Ptr, size_t key,
+                                      const TokenGroup::Ptr& except = nullptr) const;
 
 
 
@@ -78,6 +101,7 @@ public:
         Add an accessor that serves as a criteria for the created groups.
         Groups are created such that every given accessor returns the same
         value for all entries in a group.
+        Throws if the accessor has no interpretation to compare its values.
     */
     void addCriteria(std::unique_ptr<AccessorBase>&&);
 
@@ -93,6 +117,11 @@ public:
     void leftActivate(Token::Ptr, PropagationFlag) override;
 
     bool operator == (const BetaNode& other) const override;
+
+    /**
+        The groups and the indexes of the groups and tokens
+    */
+    size_t getMemoryUsage() const override;
 };
 
 
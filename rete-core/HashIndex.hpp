@@ -0,0 +1,125 @@
+#ifndef RETE_HASHINDEX_HPP_
+#define RETE_HASHINDEX_HPP_
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+#include "MemoryUsage.hpp"
+
+namespace rete {
+
+/**
+    A small helper to index shared pointers (e.g. WMEs or Tokens) by a hash
+    key, used by join nodes to find the entries of a memory that may match a
+    given token or wme without scanning the whole memory.
+
+    Every entry remembers the key it was inserted with, so it can be removed
+    even if the values the key was computed from changed in the meantime
+    (think of UPDATEs of mutable WMEs). It also remembers its position in
+    the bucket of the key, as keys with only few different values (e.g. the
+    class in "?x rdf:type ?class") lead to huge buckets that must not be
+    searched on every removal.
+*/
+template <class T>
+class HashIndex {
+    using Ptr = std::shared_ptr<T>;
+
+    struct Position {
+        size_t key;
+        size_t index;
+    };
+
+    std::unordered_map<size_t, std::vector<Ptr>> entries_;
+    std::unordered_map<const T*, Position> positions_;
+
+public:
+    /**
+        Adds an entry with the given key. If the entry is already indexed it
+        is moved to the new key, so inserting an entry twice is harmless.
+    */
+    void insert(size_t key, Ptr entry)
+    {
+        auto it = positions_.find(entry.get());
+        if (it != positions_.end())
+        {
+            if (it->second.key == key) return;
+            remove(entry);
+        }
+
+        auto& bucket = entries_[key];
+        positions_[entry.get()] = Position{key, bucket.size()};
+        bucket.push_back(std::move(entry));
+    }
+
+    /**
+        Removes the entry, if it is indexed.
+    */
+    void remove(const Ptr& entry)
+    {
+        auto it = positions_.find(entry.get());
+        if (it == positions_.end()) return;
+
+        Position pos = it->second;
+        positions_.erase(it);
+
+        // replace the entry with the last one of the bucket
+        auto bucket = entries_.find(pos.key);
+        auto& entries = bucket->second;
+        if (pos.index + 1 != entries.size())
+        {
+            entries[pos.index] = std::move(entries.back());
+            positions_[entries[pos.index].get()].index = pos.index;
+        }
+        entries.pop_back();
+        if (entries.empty()) entries_.erase(bucket);
+    }
+
+    /**
+        Looks up the key an entry was inserted with. Returns false if the
+        entry is not indexed.
+    */
+    bool getKey(const Ptr& entry, size_t& key) const
+    {
+        auto it = positions_.find(entry.get());
+        if (it == positions_.end()) return false;
+
+        key = it->second.key;
+        return true;
+    }
+
+    /**
+        Appends all entries with the given key to the result.
+    */
+    void get(size_t key, std::vector<Ptr>& result) const
+    {
+        auto bucket = entries_.find(key);
+        if (bucket == entries_.end()) return;
+        result.insert(result.end(), bucket->second.begin(), bucket->second.end());
+    }
+
+    void clear()
+    {
+        entries_.clear();
+        positions_.clear();
+    }
+
+    size_t size() const
+    {
+        return positions_.size();
+    }
+
+    size_t getMemoryUsage() const
+    {
+        size_t bytes = util::memoryUsage(entries_) + util::memoryUsage(positions_);
+        for (auto& bucket : entries_)
+        {
+            bytes += util::memoryUsage(bucket.second);
+        }
+        return bytes;
+    }
+};
+
+} /* rete */
+
+#endif /* end of include guard: RETE_HASHINDEX_HPP_ */
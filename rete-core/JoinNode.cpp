@@ -1,59 +1,236 @@
 #include "JoinNode.hpp"
 #include "AlphaMemory.hpp"
 #include "TupleWME.hpp"
+#include "MemoryUsage.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <thread>
 
 namespace rete {
 
 JoinNode::JoinNode()
-    : negative_(false)
+    : negative_(false), indexed_(false)
+{
+}
+
+void JoinNode::initialize()
+{
+    indexed_ = false;
+    alphaIndex_.clear();
+    betaIndex_.clear();
+    blocked_.clear();
+    blocking_.clear();
+
+    BetaNode::initialize();
+}
+
+bool JoinNode::isIndexable() const
+{
+    return false;
+}
+
+size_t JoinNode::leftKey(Token::Ptr) const
+{
+    return 0;
+}
+
+size_t JoinNode::rightKey(WME::Ptr) const
+{
+    return 0;
+}
+
+void JoinNode::buildIndexes()
+{
+    if (indexed_) return;
+
+    for (auto wme : *parentAlpha_)
+    {
+        alphaIndex_.insert(rightKey(wme), wme);
+    }
+
+    for (auto token : *parentBeta_)
+    {
+        betaIndex_.insert(leftKey(token), token);
+    }
+
+    indexed_ = true;
+}
+
+void JoinNode::updateIndex(WME::Ptr wme, PropagationFlag flag, std::vector<Token::Ptr>& candidates)
+{
+    if (!isIndexable())
+    {
+        if (flag != PropagationFlag::RETRACT)
+            candidates.assign(parentBeta_->begin(), parentBeta_->end());
+        return;
+    }
+
+    // Note: The alpha memory already contains the changes, so if the indexes are built only now
+    // we won't know the previous key of the wme.
+    size_t previousKey = 0;
+    bool previousKnown = indexed_ && alphaIndex_.getKey(wme, previousKey);
+    buildIndexes();
+
+    if (flag == PropagationFlag::RETRACT)
+    {
+        alphaIndex_.remove(wme);
+        return;
+    }
+
+    size_t key = rightKey(wme);
+    alphaIndex_.insert(key, wme);
+
+    if (flag == PropagationFlag::UPDATE && !previousKnown)
+    {
+        // no idea what matched before, check everything.
+        candidates.assign(parentBeta_->begin(), parentBeta_->end());
+        return;
+    }
+
+    betaIndex_.get(key, candidates);
+    if (flag == PropagationFlag::UPDATE && previousKey != key)
+    {
+        betaIndex_.get(previousKey, candidates);
+    }
+}
+
+void JoinNode::updateIndex(Token::Ptr token, PropagationFlag flag, std::vector<WME::Ptr>& candidates)
+{
+    if (!isIndexable())
+    {
+        if (flag != PropagationFlag::RETRACT)
+            candidates.assign(parentAlpha_->begin(), parentAlpha_->end());
+        return;
+    }
+
+    size_t previousKey = 0;
+    bool previousKnown = indexed_ && betaIndex_.getKey(token, previousKey);
+    buildIndexes();
+
+    if (flag == PropagationFlag::RETRACT)
+    {
+        betaIndex_.remove(token);
+        return;
+    }
+
+    size_t key = leftKey(token);
+    betaIndex_.insert(key, token);
+
+    if (flag == PropagationFlag::UPDATE && !previousKnown)
+    {
+        candidates.assign(parentAlpha_->begin(), parentAlpha_->end());
+        return;
+    }
+
+    alphaIndex_.get(key, candidates);
+    if (flag == PropagationFlag::UPDATE && previousKey != key)
+    {
+        alphaIndex_.get(previousKey, candidates);
+    }
+}
+
+size_t JoinNode::addBlocker(const Token::Ptr& token, const WME* wme)
+{
+    auto& entry = blocked_[token.get()];
+    entry.token = token;
+    entry.blockers.push_back(wme);
+    blocking_[wme].insert(token.get());
+    return entry.blockers.size();
+}
+
+size_t JoinNode::removeBlocker(const Token* token, const WME* wme)
+{
+    auto it = blocked_.find(token);
+    if (it == blocked_.end()) return 0;
+
+    auto& blockers = it->second.blockers;
+    auto b = std::find(blockers.begin(), blockers.end(), wme);
+    if (b != blockers.end())
+    {
+        *b = blockers.back();
+        blockers.pop_back();
+    }
+
+    auto w = blocking_.find(wme);
+    if (w != blocking_.end())
+    {
+        w->second.erase(token);
+        if (w->second.empty()) blocking_.erase(w);
+    }
+
+    size_t count = blockers.size();
+    if (count == 0) blocked_.erase(it);
+    return count;
+}
+
+size_t JoinNode::unblock(const Token* token)
 {
+    auto it = blocked_.find(token);
+    if (it == blocked_.end()) return 0;
+
+    size_t count = it->second.blockers.size();
+    for (auto wme : it->second.blockers)
+    {
+        auto w = blocking_.find(wme);
+        if (w != blocking_.end())
+        {
+            w->second.erase(token);
+            if (w->second.empty()) blocking_.erase(w);
+        }
+    }
+    blocked_.erase(it);
+    return count;
+}
+
+void JoinNode::release(const Token::Ptr& token, BetaMemory::Ptr& bmem)
+{
+    EmptyWME::Ptr empty(new EmptyWME());
+    empty->isComputed_ = true;
+    bmem->leftActivate(token, empty, PropagationFlag::ASSERT);
+}
+
+bool JoinNode::checkCombination(const Token::Ptr& token, const WME::Ptr& wme)
+{
+    bool match = isValidCombination(token, wme);
+    RETE_NODE_STATS(stats_.checked(match));
+    return match;
 }
 
 void JoinNode::rightActivate(WME::Ptr wme, PropagationFlag flag)
 {
+    RETE_NODE_ACTIVATION(stats_, flag);
     auto bmem = bmem_.lock();
     if (!bmem) throw std::exception(); // should not be possible, as the bmem holds this alive.
 
+    std::vector<Token::Ptr> candidates;
+    updateIndex(wme, flag, candidates);
+
     // --- RETRACT ---
     if (flag == PropagationFlag::RETRACT)
     {
         // retracting a wme is a chance to create a new result in a negative join
         if (isNegative())
         {
-            // need to check all tokens that have been held back
-            for (auto it = heldBackTokens_.begin(); it != heldBackTokens_.end(); /*no incr*/)
+            // only the tokens blocked by exactly this wme can be affected. Those that are not
+            // blocked by anything else anymore can be released.
+            auto it = blocking_.find(wme.get());
+            if (it == blocking_.end()) return;
+
+            std::vector<const Token*> tokens(it->second.begin(), it->second.end());
+            std::vector<Token::Ptr> toRelease;
+            for (auto token : tokens)
             {
-                // if it was held back because of a match with this exact wme, check if we can release the token
-                if (it->second == wme)
-                {
-                    // found a token (it->first) that was held back due to this wme
-                    // try to find another reason to hold it back
-                    bool foundMatch = false;
-                    for (auto alpha : *parentAlpha_)
-                    {
-                        if (isValidCombination(it->first, alpha))
-                        {
-                            heldBackTokens_[it->first] = alpha;
-                            foundMatch = true;
-                            break;
-                        }
-                    }
+                auto entry = blocked_.find(token);
+                if (entry == blocked_.end()) continue;
 
-                    if (foundMatch) it++;
-                    else
-                    {
-                        // no need to hold the token back anymore
-                        auto token = it->first;
-                        it = heldBackTokens_.erase(it);
-                        EmptyWME::Ptr empty(new EmptyWME());
-                        empty->isComputed_ = true;
-                        bmem->leftActivate(token, empty, PropagationFlag::ASSERT);
-                    }
-                }
-                else
-                {
-                    it++;
-                }
+                Token::Ptr keep = entry->second.token;
+                if (removeBlocker(token, wme.get()) == 0) toRelease.push_back(keep);
+            }
+
+            for (auto& token : toRelease)
+            {
+                release(token, bmem);
             }
         }
         else
@@ -69,19 +246,18 @@ void JoinNode::rightActivate(WME::Ptr wme, PropagationFlag flag)
     {
         if (isNegative())
         {
-            // check the output memory if we need to retract something due to a new match
+            // check if we need to retract something due to a new match. Every token that is not
+            // blocked yet has been forwarded to the output memory.
             std::vector<Token::Ptr> toRetract;
-            for (auto token : *bmem)
+            for (auto& token : candidates)
             {
-                // remember: the token is bmem is one element longer, last one is an empty wme.
-                if (isValidCombination(token->parent, wme))
+                if (checkCombination(token, wme))
                 {
-                    heldBackTokens_[token->parent] = wme;
-                    toRetract.push_back(token->parent);
+                    if (addBlocker(token, wme.get()) == 1) toRetract.push_back(token);
                 }
             }
             // dont remove (leftActivate with retract) from the bmem while iterating it!
-            for (auto token : toRetract)
+            for (auto& token : toRetract)
             {
                 bmem->leftActivate(token, nullptr, PropagationFlag::RETRACT);
             }
@@ -89,9 +265,9 @@ void JoinNode::rightActivate(WME::Ptr wme, PropagationFlag flag)
         else
         {
             // since the wme was added, check for all tokens on the left side if we have a match
-            for (auto token : *parentBeta_)
+            for (auto& token : candidates)
             {
-                if (isValidCombination(token, wme))
+                if (checkCombination(token, wme))
                 {
                     bmem->leftActivate(token, wme, flag);
                 }
@@ -108,109 +284,67 @@ void JoinNode::rightActivate(WME::Ptr wme, PropagationFlag flag)
             and explicitely propagate UPDATE on match and RETRACT on no-match.
 
             In the negative case:
-            Similar to RETRACT we need to re-check all tokens that have been held back due to the
-            updated wme, if it is still the case. Also, we need to check all other tokens if they
-            now match the wme, and if so add them to the heldBackTokens_ list. (And RETRACT them,
-            of course).
-            This can be done in one loop:
-            for every token:
-                if it is held back:
-                    if it is held back by exactly this wme:
-                        if it still matches:
-                            nothing to do.
-                        else:
-                            # just like in the RETRACT case
-                            if another wme matches the token:
-                                save that
-                            else:
-                                ASSERT the token
-                    else:
-                        nothing todo, there is another wme blocking this token.
-                else:
-                    check if the wme now matches and thus blocks the token
-                    if it matches:
-                        RETRACT the token
-
-            as you see, the UPDATEd wme never leads to an UPDATEd token (in the negative case!),
+            Every token the wme blocked before is re-checked. If it does not match anymore, the
+            wme is removed from its blockers, and if none are left the token is ASSERTed -- just
+            like in the RETRACT case.
+            Every other candidate is checked if it now matches the wme. If so, the wme is added
+            to its blockers, and if it was not blocked before the token is RETRACTed.
+
+            As you see, the UPDATEd wme never leads to an UPDATEd token (in the negative case!),
             since the wme is not part of the "match" (better: "result") -- as there is only a
             result if there is no match!
         */
         if (isNegative())
         {
-            // for every token
-            for (auto token : *parentBeta_)
+            std::unordered_set<const Token*> blockedBefore;
+            auto it = blocking_.find(wme.get());
+            if (it != blocking_.end()) blockedBefore = it->second;
+
+            std::vector<Token::Ptr> toRelease;
+            for (auto token : blockedBefore)
             {
-                // is it held back?
-                auto it = heldBackTokens_.find(token);
-                if (it != heldBackTokens_.end())
+                auto entry = blocked_.find(token);
+                if (entry == blocked_.end()) continue;
+
+                Token::Ptr keep = entry->second.token;
+                if (!checkCombination(keep, wme) &&
+                    removeBlocker(token, wme.get()) == 0)
                 {
-                    if (it->second == wme)
-                    {
-                        if (isValidCombination(token, wme))
-                        {
-                            // nothing to do, still blocking.
-                        }
-                        else
-                        {
-                            // just like in retract:
-                            // try to find another reason to hold it back
-                            bool foundMatch = false;
-                            for (auto alpha : *parentAlpha_)
-                            {
-                                if (isValidCombination(token, alpha))
-                                {
-                                    heldBackTokens_[token] = alpha;
-                                    foundMatch = true;
-                                    break;
-                                }
-                            }
-                            // none found? remove the token from the held-back-list and ASSERT it.
-                            if (foundMatch)
-                            {
-                                // nothing to do. already saved the new reason to hold the token
-                                // back
-                            }
-                            else
-                            {
-                                // no need to hold the token back anymore, ASSERT the token
-                                heldBackTokens_.erase(it);
-                                EmptyWME::Ptr empty(new EmptyWME());
-                                empty->isComputed_ = true;
-                                bmem->leftActivate(token, empty, PropagationFlag::ASSERT);
-                            }
-                        }
-                    }
-                    else
-                    {
-                        // nothing to do, token is held back by a different wme
-                    }
+                    toRelease.push_back(keep);
                 }
-                else
+            }
+
+            std::vector<Token::Ptr> toRetract;
+            for (auto& token : candidates)
+            {
+                if (blockedBefore.find(token.get()) != blockedBefore.end()) continue;
+
+                if (checkCombination(token, wme))
                 {
-                    // token is currently not being held back! so check if we have a reason to do
-                    // so now:
-                    if (isValidCombination(token, wme))
-                    {
-                        // retract and hold back because of the match
-                        heldBackTokens_[token] = wme;
-                        bmem->leftActivate(token, nullptr, PropagationFlag::RETRACT);
-                    }
-                    else
-                    {
-                        // nope. nothing to do.
-                    }
+                    if (addBlocker(token, wme.get()) == 1) toRetract.push_back(token);
                 }
-            } // end for all tokens.
+            }
+
+            for (auto& token : toRelease)
+            {
+                release(token, bmem);
+            }
+            for (auto& token : toRetract)
+            {
+                bmem->leftActivate(token, nullptr, PropagationFlag::RETRACT);
+            }
         }
         else
         {
             /*
                 In the non-negative case it is simple: Go through all tokens, just like in an
                 ASSERT, and explicitely propagate UPDATE on match and RETRACT on no-match.
+                (Only for the tokens that match or have matched before, though. All others
+                would not change anything.)
             */
-            for (auto token : *parentBeta_)
+            for (auto& token : candidates)
             {
-                if (isValidCombination(token, wme))
+                if (checkCombination(token, wme))
                 {
                     bmem->leftActivate(token, wme, PropagationFlag::UPDATE);
                 }
@@ -223,11 +357,158 @@ void JoinNode::rightActivate(WME::Ptr wme, PropagationFlag flag)
     }
 }
 
+// joining batches on multiple threads is only worth it with enough checks to do per thread
+static const size_t minCombinationsPerThread = 4096;
+
+void JoinNode::rightActivateBatch(const std::vector<WME::Ptr>& wmes, PropagationFlag flag,
+                                  size_t threads)
+{
+    if (flag != PropagationFlag::ASSERT || isNegative())
+    {
+        BetaNode::rightActivateBatch(wmes, flag, threads);
+        return;
+    }
+
+    RETE_NODE_ACTIVATION(stats_, flag, wmes.size());
+
+    auto bmem = bmem_.lock();
+    if (!bmem) throw std::exception(); // should not be possible, as the bmem holds this alive.
+
+    std::vector<BatchGroup> groups;
+    std::unordered_map<size_t, std::vector<WME::Ptr>> byKey;
+    if (!isIndexable())
+    {
+        // a single pass over the beta memory for the whole batch
+        groups.push_back({{parentBeta_->begin(), parentBeta_->end()}, &wmes});
+    }
+    else
+    {
+        // group the batch by key, so that every bucket of the beta index is looked up only once
+        buildIndexes();
+        for (auto& wme : wmes)
+        {
+            size_t key = rightKey(wme);
+            alphaIndex_.insert(key, wme);
+            byKey[key].push_back(wme);
+        }
+
+        for (auto& entry : byKey)
+        {
+            groups.push_back({{}, &entry.second});
+            betaIndex_.get(entry.first, groups.back().tokens);
+        }
+    }
+
+    size_t combinations = 0;
+    for (auto& group : groups)
+    {
+        combinations += group.tokens.size() * group.wmes->size();
+    }
+
+    if (threads > 1 && isConcurrent() && combinations >= 2 * minCombinationsPerThread)
+    {
+        joinConcurrently(groups, std::min(threads, combinations / minCombinationsPerThread),
+                         bmem);
+        return;
+    }
+
+    for (auto& group : groups)
+    {
+        for (auto& token : group.tokens)
+        {
+            for (auto& wme : *group.wmes)
+            {
+                if (checkCombination(token, wme))
+                {
+                    bmem->leftActivate(token, wme, flag);
+                }
+            }
+        }
+    }
+}
+
+void JoinNode::joinConcurrently(const std::vector<BatchGroup>& groups, size_t threads,
+                                BetaMemory::Ptr& bmem)
+{
+    // Split the groups into partitions of about minCombinationsPerThread checks, which are
+    // distributed to the threads. Large groups (e.g. the single group of a join that is not
+    // indexable) are split by ranges of tokens.
+    struct Partition {
+        const BatchGroup* group;
+        size_t begin, end;
+        std::vector<std::pair<Token::Ptr, WME::Ptr>> matches;
+    };
+
+    std::vector<Partition> partitions;
+    for (auto& group : groups)
+    {
+        if (group.wmes->empty()) continue;
+        size_t step = std::max<size_t>(1, minCombinationsPerThread / group.wmes->size());
+        for (size_t begin = 0; begin < group.tokens.size(); begin += step)
+        {
+            partitions.push_back({&group, begin, std::min(begin + step, group.tokens.size()), {}});
+        }
+    }
+
+    std::vector<std::exception_ptr> errors(threads);
+    auto match = [&](size_t thread)
+    {
+        try
+        {
+            for (size_t i = thread; i < partitions.size(); i += threads)
+            {
+                auto& partition = partitions[i];
+                for (size_t t = partition.begin; t < partition.end; t++)
+                {
+                    auto& token = partition.group->tokens[t];
+                    for (auto& wme : *partition.group->wmes)
+                    {
+                        if (checkCombination(token, wme))
+                        {
+                            partition.matches.push_back({token, wme});
+                        }
+                    }
+                }
+            }
+        }
+        catch (...)
+        {
+            errors[thread] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t thread = 1; thread < threads; thread++)
+    {
+        workers.emplace_back(match, thread);
+    }
+    match(0);
+    for (auto& worker : workers) worker.join();
+
+    for (auto& error : errors)
+    {
+        if (error) std::rethrow_exception(error);
+    }
+
+    // the partitions are in the same order as the checks without threads
+    for (auto& partition : partitions)
+    {
+        for (auto& m : partition.matches)
+        {
+            bmem->leftActivate(m.first, m.second, PropagationFlag::ASSERT);
+        }
+    }
+}
+
 void JoinNode::leftActivate(Token::Ptr token, PropagationFlag flag)
 {
+    RETE_NODE_ACTIVATION(stats_, flag);
     auto bmem = bmem_.lock();
     if (!bmem) throw std::exception();
 
+    std::vector<WME::Ptr> candidates;
+    updateIndex(token, flag, candidates);
+
     // --- RETRACT ---
     if (flag == PropagationFlag::RETRACT)
     {
@@ -235,13 +516,13 @@ void JoinNode::leftActivate(Token::Ptr token, PropagationFlag flag)
         bmem->leftActivate(token, nullptr, PropagationFlag::RETRACT);
 
         // But maybe the token was never propagated to the beta memory, but held
-        // back to check later. In this case we have to remove it from the list
-        // of held-back-tokens, since it would otherwise suddenly be propagated
+        // back to check later. In this case we have to remove it from the
+        // blocker indexes, since it would otherwise suddenly be propagated
         // when the reason for holding it back vanishes, although the token
         // has long been retracted itself.
         // As you might have guessed from the length of this comment:
         //      I've just had this exact problem.
-        heldBackTokens_.erase(token);
+        unblock(token.get());
         return;
     }
 
@@ -250,16 +531,16 @@ void JoinNode::leftActivate(Token::Ptr token, PropagationFlag flag)
         // --- ASSERT ---
         // check all WMEs in the alpha memory if they match this token
         auto foundMatch = false;
-        for (auto wme : *parentAlpha_)
+        for (auto& wme : candidates)
         {
-            if (isValidCombination(token, wme))
+            if (checkCombination(token, wme))
             {
                 foundMatch = true;
                 if (isNegative())
                 {
-                    // if a match is found and the join is negative, hold the token back, and remember why.
-                    heldBackTokens_[token] = wme;
-                    break;
+                    // if a match is found and the join is negative, hold the token back, and
+                    // count every wme that blocks it.
+                    addBlocker(token, wme.get());
                 }
                 else
                 {
@@ -271,79 +552,43 @@ void JoinNode::leftActivate(Token::Ptr token, PropagationFlag flag)
         // if no match was found and the join is negative, propagate the token with an empty wme
         if (isNegative() && !foundMatch)
         {
-            EmptyWME::Ptr empty(new EmptyWME());
-            empty->isComputed_ = true;
-            bmem->leftActivate(token, empty, PropagationFlag::ASSERT);
+            release(token, bmem);
         }
     }
     else if (flag == PropagationFlag::UPDATE)
     {
         /*
-            In the negative case, the token must be checked against the reason it was held back
-            again. If that still matches all is good, else we search for another reason. If not
-            found we assert the token. If the token wasn't held back before we need to check with
-            all wmes if there is a reason now.
+            In the negative case the blockers of the token are counted again from scratch, as the
+            token might now match a different set of wmes. Only the transition between blocked
+            and not blocked matters: Released tokens are ASSERTed, newly blocked tokens RETRACTed,
+            and tokens that stay unblocked propagate the UPDATE.
         */
         if (isNegative())
         {
-            auto it = heldBackTokens_.find(token);
-            if (it != heldBackTokens_.end())
+            bool wasBlocked = unblock(token.get()) > 0;
+            bool isBlocked = false;
+            for (auto& alpha : candidates)
             {
-                // check again.
-                if (isValidCombination(token, it->second))
+                if (checkCombination(token, alpha))
                 {
-                    // nothing todo, all good.
+                    addBlocker(token, alpha.get());
+                    isBlocked = true;
                 }
-                else
-                {
-                    // search another reason to hold it back.
-                    bool foundMatch = false;
-                    for (auto alpha : *parentAlpha_)
-                    {
-                        if (isValidCombination(token, alpha))
-                        {
-                            heldBackTokens_[token] = alpha;
-                            foundMatch = true;
-                            break;
-                        }
-                    }
+            }
 
-                    if (foundMatch)
-                    {
-                        // nothing to do. already saved the new reason to hold the token
-                        // back
-                    }
-                    else
-                    {
-                        // no need to hold the token back anymore, ASSERT the token
-                        heldBackTokens_.erase(it);
-                        EmptyWME::Ptr empty(new EmptyWME());
-                        empty->isComputed_ = true;
-                        bmem->leftActivate(token, empty, PropagationFlag::ASSERT);
-                    }
-                }
+            if (wasBlocked && !isBlocked)
+            {
+                // no need to hold the token back anymore, ASSERT the token
+                release(token, bmem);
             }
-            else
+            else if (!wasBlocked && isBlocked)
             {
-                // not held back before, well, maybe now?
-                bool foundMatch = false;
-                for (auto alpha : *parentAlpha_)
-                {
-                    if (isValidCombination(token, alpha))
-                    {
-                        // yep! RETRACT it!
-                        heldBackTokens_[token] = alpha;
-                        bmem->leftActivate(token, nullptr, PropagationFlag::RETRACT);
-                        break;
-                    }
-                }
-
-                if (!foundMatch)
-                {
-                    // no, still don't need to hold it back, so now propagate the UPDATE on the
-                    // token.
-                    bmem->leftActivate(token, nullptr, PropagationFlag::UPDATE);
-                }
+                bmem->leftActivate(token, nullptr, PropagationFlag::RETRACT);
+            }
+            else if (!wasBlocked && !isBlocked)
+            {
+                // still don't need to hold it back, so now propagate the UPDATE on the token.
+                bmem->leftActivate(token, nullptr, PropagationFlag::UPDATE);
             }
         }
         /*
@@ -353,9 +598,9 @@ void JoinNode::leftActivate(Token::Ptr token, PropagationFlag flag)
         */
         else
         {
-            for (auto alpha : *parentAlpha_)
+            for (auto& alpha : candidates)
             {
-                if (isValidCombination(token, alpha))
+                if (checkCombination(token, alpha))
                 {
                     bmem->leftActivate(token, alpha, PropagationFlag::UPDATE);
                 }
@@ -368,6 +613,11 @@ void JoinNode::leftActivate(Token::Ptr token, PropagationFlag flag)
     }
 }
 
+bool JoinNode::isConcurrent() const
+{
+    return false;
+}
+
 bool JoinNode::isNegative() const
 {
     return negative_;
@@ -383,4 +633,15 @@ std::string JoinNode::getDOTAttr() const
     return std::string("[label=") + (isNegative() ? "negative " : "") + "JoinNode]";
 }
 
+size_t JoinNode::getMemoryUsage() const
+{
+    size_t bytes = alphaIndex_.getMemoryUsage()
+                 + betaIndex_.getMemoryUsage()
+                 + util::memoryUsage(blocked_)
+                 + util::memoryUsage(blocking_);
+    for (auto& entry : blocked_) bytes += util::memoryUsage(entry.second.blockers);
+    for (auto& entry : blocking_) bytes += util::memoryUsage(entry.second);
+    return bytes;
+}
+
 } /* rete */
@@ -2,8 +2,11 @@
 #define RETE_JOINNODE_HPP_
 
 #include "BetaNode.hpp"
+#include "HashIndex.hpp"
 
-#include <map>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace rete {
 
@@ -18,24 +21,132 @@ class JoinNode : public BetaNode {
 
     /**
         If a Join is declared negative, it forwards all tokens for which there is *no* matching wme.
-        It keeps track of the first matching wme for all retracted tokens. This is a compromise:
-        Don't need to check *all* WMEs and create a complete list of reasons to retract a token,
-        but also don't need to recheck all retracted tokens once a single WME is retracted (but
-        only those who were not retracted because of a different WME).
+        For every token it counts the wmes that currently block it, and for every wme it keeps a
+        reverse index of the tokens it blocks. That way a new wme only needs to check the tokens
+        in its bucket of the join index, and a retracted wme only needs to touch the tokens it
+        actually blocked -- those whose count drops to zero are released, without ever rescanning
+        the alpha memory.
 
-        - For every new token, it checks if there is a valid wme in the alpha memory. If not, it forwards the token.
-        - For every new wme, it checks its *output*-memory - if there is a valid token for this wme, it is retracted.
-        - Token-retractions are simply forwarded to the output memory.
-        - For every retracted wme, it checks the tokens that are held back because of it again on all other WMEs. If no "isValidCombination" is found, forwards the token.
+        - For every new token, it counts the matching wmes in the alpha memory. If there are none, it forwards the token.
+        - For every new wme, it checks the tokens in its bucket - every token that was not blocked before is retracted.
+        - Token-retractions are forwarded to the output memory, and the token is removed from the indexes.
+        - For every retracted wme, the tokens blocked by it are decremented, and forwarded if nothing else blocks them.
     */
     bool negative_;
-    std::map<Token::Ptr, WME::Ptr> heldBackTokens_;
+
+    struct BlockedToken {
+        Token::Ptr token;
+        std::vector<const WME*> blockers;
+    };
+    std::unordered_map<const Token*, BlockedToken> blocked_;
+    std::unordered_map<const WME*, std::unordered_set<const Token*>> blocking_;
+
+    /**
+        Records/removes that the given wme blocks the given token. Both return the number of wmes
+        blocking the token afterwards.
+    */
+    size_t addBlocker(const Token::Ptr&, const WME*);
+    size_t removeBlocker(const Token*, const WME*);
+
+    /**
+        Removes all records of the given token being blocked, and returns how many wmes blocked it.
+    */
+    size_t unblock(const Token*);
+
+    /**
+        Forwards a token that is no longer blocked by anything, with an empty wme appended.
+    */
+    void release(const Token::Ptr&, BetaMemory::Ptr&);
+
+    /**
+        If the join condition allows it (see isIndexable()), the join keeps hash indexes on the
+        contents of its parent memories, so that an activation only needs to check the tokens/wmes
+        in the matching bucket instead of the whole memory.
+        The indexes are built lazily from the current contents of the parent memories on the first
+        activation after initialize(), and kept in sync with the memories through the
+        activations afterwards.
+    */
+    bool indexed_;
+    HashIndex<WME> alphaIndex_;
+    HashIndex<Token> betaIndex_;
+
+    /**
+        Builds the indexes from the contents of the parent memories, if not already done.
+    */
+    void buildIndexes();
+
+    /**
+        A part of the combinations to check in rightActivateBatch: Every token is checked with
+        every wme of the same group.
+    */
+    struct BatchGroup {
+        std::vector<Token::Ptr> tokens;
+        const std::vector<WME::Ptr>* wmes;
+    };
+
+    /**
+        Checks the combinations of the groups on the given number of threads, and forwards the
+        matches to the beta memory in the same order as a sequential check would.
+    */
+    void joinConcurrently(const std::vector<BatchGroup>&, size_t threads, BetaMemory::Ptr&);
+
+    /**
+        Updates the alpha index for the given activation and collects the tokens of the parent
+        beta memory that need to be checked against the wme. On an UPDATE this includes the
+        tokens that matched the previous values of the wme, as they might need to be retracted.
+        Without an index these are simply all tokens of the parent beta memory.
+    */
+    void updateIndex(WME::Ptr, PropagationFlag, std::vector<Token::Ptr>& candidates);
+
+    /**
+        Same as above, for the beta index: Collects the wmes that need to be checked against the
+        given token.
+    */
+    void updateIndex(Token::Ptr, PropagationFlag, std::vector<WME::Ptr>& candidates);
+
+    /**
+        Calls isValidCombination, and records the check in the statistics of the node.
+    */
+    bool checkCombination(const Token::Ptr&, const WME::Ptr&);
+
+protected:
+    /**
+        Resets the indexes and re-evaluates the contents of the parent beta memory.
+    */
+    void initialize() override;
+
+    /**
+        Join nodes whose condition is a conjunction of equality checks can compute hash keys for
+        tokens and wmes, with the guarantee that a token and wme with different keys can never
+        be a valid combination. Such nodes override isIndexable() to return true and implement
+        leftKey and rightKey, which enables the hash indexes.
+        The default implementation is not indexable and checks every combination.
+    */
+    virtual bool isIndexable() const;
+    virtual size_t leftKey(Token::Ptr) const;
+    virtual size_t rightKey(WME::Ptr) const;
 
 public:
     JoinNode();
     void rightActivate(WME::Ptr, PropagationFlag) override;
     void leftActivate(Token::Ptr, PropagationFlag) override;
 
+    /**
+        Joins a whole batch of new WMEs with the tokens of the parent beta memory. Indexed joins
+        group the batch by key and look up every bucket of the beta index only once, others
+        iterate the beta memory only once for the whole batch. Negative joins and other flags
+        fall back to one activation per WME.
+
+        If the join isConcurrent() and there are enough combinations to check, the checks are
+        partitioned by join key (or by ranges of tokens, if not indexable) and done by up to the
+        given number of threads. The matches are collected per partition, and only when all
+        threads are done they are forwarded to the beta memory on the calling thread, in the
+        same order as without threads. So everything below the join, and the agenda, are
+        never accessed concurrently.
+    */
+    void rightActivateBatch(const std::vector<WME::Ptr>&, PropagationFlag,
+                            size_t threads) override;
+
     /**
         Checks if the join is negative.
         Negative joins only forward a token (with an appended empty wme) when there is no matching
@@ -48,7 +159,19 @@ public:
         Check if a token and a wme together fulfill the join condition. Override this method to
         implement the conditions.
     */
-    virtual bool isValidCombination(Token::Ptr, WME::Ptr) = 0;
+    virtual bool isValidCombination(const Token::Ptr&, const WME::Ptr&) = 0;
+
+    /**
+        Returns true if isValidCombination may be called concurrently, which requires that it
+        does not modify anything. Only then large batches are joined on multiple threads.
+        The default implementation returns false.
+    */
+    virtual bool isConcurrent() const;
+
+    /**
+        The hash indexes, and the records of blocked tokens in negative joins
+    */
+    size_t getMemoryUsage() const override;
 };
 
 } /* rete */
@@ -0,0 +1,90 @@
+#ifndef RETE_MEMORYUSAGE_HPP_
+#define RETE_MEMORYUSAGE_HPP_
+
+#include <cstddef>
+#include <vector>
+#include <list>
+#include <set>
+#include <map>
+#include <unordered_set>
+#include <unordered_map>
+
+namespace rete {
+namespace util {
+
+/**
+    Helpers to estimate the number of bytes allocated by the standard containers, used to
+    implement the getMemoryUsage() methods of nodes and other data structures.
+
+    They count what the container allocates itself, with the overhead of a typical (i.e.
+    libstdc++) implementation: The elements, the nodes they are stored in, and the bucket arrays
+    of hash containers. Memory that the elements allocate on their own is not included and has
+    to be added by the caller, if it matters.
+*/
+template <class T, class A>
+size_t memoryUsage(const std::vector<T, A>& c)
+{
+    return c.capacity() * sizeof(T);
+}
+
+template <class T, class A>
+size_t memoryUsage(const std::list<T, A>& c)
+{
+    // prev and next pointer per node
+    return c.size() * (sizeof(T) + 2 * sizeof(void*));
+}
+
+/**
+    Tree nodes store the color and three pointers (parent, left, right) besides the element.
+*/
+template <class C>
+size_t treeMemoryUsage(const C& c)
+{
+    return c.size() * (sizeof(typename C::value_type) + 4 * sizeof(void*));
+}
+
+template <class... Args>
+size_t memoryUsage(const std::set<Args...>& c) { return treeMemoryUsage(c); }
+
+template <class... Args>
+size_t memoryUsage(const std::multiset<Args...>& c) { return treeMemoryUsage(c); }
+
+template <class... Args>
+size_t memoryUsage(const std::map<Args...>& c) { return treeMemoryUsage(c); }
+
+/**
+    Hash nodes store the next pointer and the cached hash besides the element, and every bucket
+    is a pointer.
+*/
+template <class C>
+size_t hashMemoryUsage(const C& c)
+{
+    return c.size() * (sizeof(typename C::value_type) + sizeof(void*) + sizeof(size_t))
+         + c.bucket_count() * sizeof(void*);
+}
+
+template <class... Args>
+size_t memoryUsage(const std::unordered_set<Args...>& c) { return hashMemoryUsage(c); }
+
+template <class... Args>
+size_t memoryUsage(const std::unordered_map<Args...>& c) { return hashMemoryUsage(c); }
+
+template <class... Args>
+size_t memoryUsage(const std::unordered_multimap<Args...>& c) { return hashMemoryUsage(c); }
+
+/**
+    The size of an object that is held by a shared_ptr created through std::make_shared, i.e.
+    including the reference counts.
+    Not exact for objects that were allocated separately (two allocations) or through a pool
+    (like tokens), but close enough.
+*/
+template <class T>
+constexpr size_t sharedMemoryUsage()
+{
+    return sizeof(T) + 2 * sizeof(void*);
+}
+
+} /* util */
+} /* rete */
+
+#endif /* end of include guard: RETE_MEMORYUSAGE_HPP_ */
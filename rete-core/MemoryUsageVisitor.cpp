@@ -0,0 +1,97 @@
+#include "MemoryUsageVisitor.hpp"
+#include "AlphaNode.hpp"
+#include "AlphaMemory.hpp"
+#include "BetaNode.hpp"
+#include "BetaMemory.hpp"
+#include "BetaBetaNode.hpp"
+#include "ProductionNode.hpp"
+
+namespace rete {
+
+MemoryUsageVisitor::MemoryUsageVisitor()
+    : alphaNodes_(0), alphaMemories_(0), betaNodes_(0), betaMemories_(0), productionNodes_(0)
+{
+}
+
+void MemoryUsageVisitor::count(const Node* node, size_t& kind)
+{
+    auto p = nodes_.insert({node, 0});
+    if (!p.second) return; // already counted
+
+    p.first->second = node->getMemoryUsage();
+    kind += p.first->second;
+}
+
+void MemoryUsageVisitor::visit(AlphaNode* node)
+{
+    count(node, alphaNodes_);
+}
+
+void MemoryUsageVisitor::visit(AlphaMemory* node)
+{
+    count(node, alphaMemories_);
+}
+
+void MemoryUsageVisitor::visit(BetaNode* node)
+{
+    count(node, betaNodes_);
+}
+
+void MemoryUsageVisitor::visit(BetaMemory* node)
+{
+    count(node, betaMemories_);
+}
+
+void MemoryUsageVisitor::visit(BetaBetaNode* node)
+{
+    count(node, betaNodes_);
+}
+
+void MemoryUsageVisitor::visit(ProductionNode* node)
+{
+    count(node, productionNodes_);
+}
+
+size_t MemoryUsageVisitor::alphaNodes() const
+{
+    return alphaNodes_;
+}
+
+size_t MemoryUsageVisitor::alphaMemories() const
+{
+    return alphaMemories_;
+}
+
+size_t MemoryUsageVisitor::betaNodes() const
+{
+    return betaNodes_;
+}
+
+size_t MemoryUsageVisitor::betaMemories() const
+{
+    return betaMemories_;
+}
+
+size_t MemoryUsageVisitor::productionNodes() const
+{
+    return productionNodes_;
+}
+
+size_t MemoryUsageVisitor::total() const
+{
+    return alphaNodes_ + alphaMemories_ + betaNodes_ + betaMemories_ + productionNodes_;
+}
+
+size_t MemoryUsageVisitor::get(const Node* node) const
+{
+    auto it = nodes_.find(node);
+    if (it == nodes_.end()) return 0;
+    return it->second;
+}
+
+size_t MemoryUsageVisitor::numNodes() const
+{
+    return nodes_.size();
+}
+
+} /* rete */
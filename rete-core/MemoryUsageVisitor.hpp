@@ -0,0 +1,67 @@
+#ifndef RETE_MEMORYUSAGEVISITOR_HPP_
+#define RETE_MEMORYUSAGEVISITOR_HPP_
+
+#include <unordered_map>
+
+#include "NodeVisitor.hpp"
+#include "Node.hpp"
+
+namespace rete {
+
+/**
+    Sums up the memory usage (see Node::getMemoryUsage()) of the nodes it visits, in total and
+    per kind of node. Every node is counted only once, no matter how often it is visited -- so the
+    same visitor can be passed to e.g. the ParsedRule::accept of several rules that share parts
+    of the network, to get their combined usage.
+
+    Use it with Network::accept to get the usage of a whole network.
+*/
+class MemoryUsageVisitor : public NodeVisitor {
+    std::unordered_map<const Node*, size_t> nodes_;
+
+    size_t alphaNodes_;
+    size_t alphaMemories_;
+    size_t betaNodes_;
+    size_t betaMemories_;
+    size_t productionNodes_;
+
+    void count(const Node*, size_t& kind);
+public:
+    MemoryUsageVisitor();
+
+    void visit(AlphaNode*) override;
+    void visit(AlphaMemory*) override;
+    void visit(BetaNode*) override;
+    void visit(BetaMemory*) override;
+    void visit(BetaBetaNode*) override;
+    void visit(ProductionNode*) override;
+
+    /**
+        The bytes used by the different kinds of nodes. BetaNodes include the BetaBetaNodes,
+        as well as all joins, builtins, GROUP BYs, ...
+    */
+    size_t alphaNodes() const;
+    size_t alphaMemories() const;
+    size_t betaNodes() const;
+    size_t betaMemories() const;
+    size_t productionNodes() const;
+
+    /**
+        The bytes used by all visited nodes
+    */
+    size_t total() const;
+
+    /**
+        The bytes used by a single node, or 0 if it was not visited
+    */
+    size_t get(const Node*) const;
+
+    /**
+        The number of visited nodes
+    */
+    size_t numNodes() const;
+};
+
+} /* rete */
+
+#endif /* end of include guard: RETE_MEMORYUSAGEVISITOR_HPP_ */
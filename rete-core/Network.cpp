@@ -6,6 +6,9 @@
 #include "BetaMemory.hpp"
 #include "BetaNode.hpp"
 #include "ProductionNode.hpp"
+#include "BetaBetaNode.hpp"
+#include "MemoryUsageVisitor.hpp"
+#include "NodeStatisticsVisitor.hpp"
 
 
 #include <sstream>
@@ -20,7 +23,28 @@ namespace {
 
     std::string drawNode(rete::Node::Ptr node)
     {
-        return node->getDOTId() + " " + node->getDOTAttr() + ";\n";
+        std::string dot = node->getDOTId() + " " + node->getDOTAttr();
+
+        // annotate the statistics of the node, if any were recorded
+        auto stats = node->getStatistics();
+        if (!stats.empty())
+        {
+            std::string label = stats.toString();
+            for (size_t i = 0; (i = label.find("\n", i)) != std::string::npos;)
+            {
+                label.replace(i, 1, "\\n");
+                i += 2;
+            }
+            dot += " [xlabel=\"" + label + "\"]";
+        }
+
+        return dot + ";\n";
+    }
+
+    // (the nodes only allow to accept visitors through the Node interface)
+    void acceptVisitor(rete::Node::Ptr node, rete::NodeVisitor& visitor)
+    {
+        node->accept(visitor);
     }
 }
 
@@ -197,4 +221,97 @@ std::string Network::toDot() const
     return dot;
 }
 
+void Network::accept(NodeVisitor& visitor) const
+{
+    // same traversal as in toDot: alpha net first, remembering the alpha memories...
+    std::set<AlphaMemory::Ptr> amems;
+    std::set<AlphaNode::Ptr> visitedANodes;
+    std::vector<AlphaNode::Ptr> toVisitANodes;
+
+    toVisitANodes.push_back(root_);
+    visitedANodes.insert(root_);
+
+    while (!toVisitANodes.empty())
+    {
+        auto last = toVisitANodes.back();
+        toVisitANodes.pop_back();
+        acceptVisitor(last, visitor);
+
+        auto amem = last->getAlphaMemory();
+        if (amem && amems.insert(amem).second) acceptVisitor(amem, visitor);
+
+        std::vector<AlphaNode::Ptr> children;
+        last->getChildren(children);
+        for (auto c : children)
+        {
+            if (visitedANodes.insert(c).second) toVisitANodes.push_back(c);
+        }
+    }
+
+    // ... and the beta net from there
+    std::set<BetaNode::Ptr> visitedBNodes;
+    std::vector<BetaNode::Ptr> toVisitBNodes;
+
+    for (auto amem : amems)
+    {
+        std::vector<BetaNode::Ptr> children;
+        amem->getChildren(children);
+        for (auto c : children)
+        {
+            if (visitedBNodes.insert(c).second) toVisitBNodes.push_back(c);
+        }
+    }
+
+    while (!toVisitBNodes.empty())
+    {
+        auto last = toVisitBNodes.back();
+        toVisitBNodes.pop_back();
+
+        // The right activators of BetaBetaNodes would visit the node they belong to, which is
+        // reached through its left parent, too.
+        bool isRightActivator = dynamic_cast<BetaBetaRightActivator*>(last.get()) != nullptr;
+        if (isRightActivator) continue;
+        acceptVisitor(last, visitor);
+
+        auto bmem = last->getBetaMemory();
+        if (!bmem) continue;
+        acceptVisitor(bmem, visitor);
+
+        std::vector<ProductionNode::Ptr> prodNodes;
+        bmem->getProductions(prodNodes);
+        for (auto prodNode : prodNodes)
+        {
+            // every ProductionNode belongs to exactly one BetaMemory
+            acceptVisitor(prodNode, visitor);
+        }
+
+        std::vector<BetaNode::Ptr> children;
+        bmem->getChildren(children);
+        for (auto c : children)
+        {
+            if (visitedBNodes.insert(c).second) toVisitBNodes.push_back(c);
+        }
+    }
+}
+
+size_t Network::getMemoryUsage() const
+{
+    MemoryUsageVisitor usage;
+    accept(usage);
+    return usage.total() + agenda_->getMemoryUsage();
+}
+
+NodeStatistics::Counts Network::getStatistics() const
+{
+    NodeStatisticsVisitor stats;
+    accept(stats);
+    return stats.total();
+}
+
+void Network::resetStatistics()
+{
+    NodeStatisticsVisitor stats(true);
+    accept(stats);
+}
+
 } /* rete */
@@ -27,6 +27,7 @@ class Network {
         using Ptr = std::shared_ptr<DummyAlpha>;
         void activate(WME::Ptr, PropagationFlag) override;
         bool operator == (const AlphaNode& other) const override;
+        bool isConcurrent() const override { return true; }
         std::string getDOTAttr() const override;
         std::string toString() const override;
     };
@@ -59,6 +60,28 @@ public:
     */
     std::string toDot() const;
 
+    /**
+        Traverses the graph of nodes and lets every node accept the visitor: All alpha nodes and
+        memories first, then the beta nodes and memories and the production nodes. Every node is
+        visited exactly once.
+    */
+    void accept(NodeVisitor&) const;
+
+    /**
+        Returns the approximate number of bytes the network uses to store its data: The contents
+        and indexes of all nodes (see Node::getMemoryUsage()) and the agenda.
+        Use a MemoryUsageVisitor with accept(...) for the details.
+    */
+    size_t getMemoryUsage() const;
+
+    /**
+        Returns the sum of the statistics of all nodes (see NodeStatistics), or resets them.
+        Use a NodeStatisticsVisitor with accept(...) for the details, and toDot() to see them
+        annotated to the nodes.
+    */
+    NodeStatistics::Counts getStatistics() const;
+    void resetStatistics();
+
 };
 
 } /* rete */
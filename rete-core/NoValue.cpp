@@ -1,5 +1,6 @@
 #include "NoValue.hpp"
 #include "TupleWME.hpp"
+#include "MemoryUsage.hpp"
 
 namespace rete {
 
@@ -20,17 +21,27 @@ std::string NoValue::toString() const
 
 Token::Ptr NoValue::getCorresponding(Token::Ptr token)
 {
-    for (size_t i = 0; i < tokenSizeDiff_; i++)
+    auto corresponding = Token::ancestor(token, tokenSizeDiff_);
+    if (!corresponding) throw std::exception();
+
+    return corresponding;
+}
+
+void NoValue::initialize()
+{
+    rightCounts_.clear();
+    for (auto& rightToken : *getRightParent())
     {
-        if (!token->parent) throw std::exception();
-        token = token->parent;
+        rightCounts_[getCorresponding(rightToken).get()]++;
     }
 
-    return token;
+    BetaBetaNode::initialize();
 }
 
 void NoValue::leftActivate(Token::Ptr token, PropagationFlag flag)
 {
+    RETE_NODE_ACTIVATION(stats_, flag);
+
     auto bmem = bmem_.lock();
     if (!bmem) throw std::exception(); // what did you doooo?!
 
@@ -42,30 +53,21 @@ void NoValue::leftActivate(Token::Ptr token, PropagationFlag flag)
     }
 
     /*
-        Iterate the items in the right memory. If any of those has a token that
-        is based on the token we got as input the "noValue" is violated and the
-        token must not be forwarded.
+        If any token in the right memory is based on the token we got as input
+        the "noValue" is violated and the token must not be forwarded.
     */
-    auto pRight = getRightParent();
-    for (auto rightToken : *pRight)
+    if (rightCounts_.find(token.get()) != rightCounts_.end())
     {
-        if(getCorresponding(rightToken) == token)
+        // there is a match for this token in the right memory.
+        // --> noValue violated.
+        if (flag == PropagationFlag::UPDATE)
         {
-            // there is a match for this token in the right memory.
-            // --> noValue violated.
-            if (flag == PropagationFlag::ASSERT)
-            {
-                // nothing to do. just dont propagate the assert.
-                return;
-            }
-            else if (flag == PropagationFlag::UPDATE)
-            {
-                // well... there might have been an assert that was okay
-                // before. to be sure, issue a RETRACT.
-                bmem->leftActivate(token, nullptr, PropagationFlag::RETRACT);
-                return;
-            }
+            // well... there might have been an assert that was okay
+            // before. to be sure, issue a RETRACT.
+            bmem->leftActivate(token, nullptr, PropagationFlag::RETRACT);
         }
+        // ASSERT: nothing to do. just dont propagate the assert.
+        return;
     }
 
     // if we get here, there has been no match in the right memory.
@@ -78,20 +80,24 @@ void NoValue::leftActivate(Token::Ptr token, PropagationFlag flag)
 
 void NoValue::rightActivate(Token::Ptr token, PropagationFlag flag)
 {
+    RETE_NODE_ACTIVATION(stats_, flag);
+
     auto bmem = bmem_.lock();
     if (!bmem) throw std::exception();
 
     if (flag == PropagationFlag::ASSERT)
     {
-        // a new entry in the exclude-list -- check the output memory, we
-        // might need to retract something from there
+        // a new entry in the exclude-list -- if it is the first one for the
+        // corresponding token, we need to retract that from the output memory.
         auto corresponding = getCorresponding(token);
-
-        // if corresponding is present in the left memory (well it is, else it
-        // could not be in the right memory, which is a descendent of left)
-        // and it exists in the output, we need to retract it from there.
-        // Nothing easier than that: just let the memory handle it.
-        bmem->leftActivate(corresponding, nullptr, PropagationFlag::RETRACT);
+        if (++rightCounts_[corresponding.get()] == 1)
+        {
+            // if corresponding is present in the left memory (well it is, else
+            // it could not be in the right memory, which is a descendent of
+            // left) and it exists in the output, we need to retract it from
+            // there. Nothing easier than that: just let the memory handle it.
+            bmem->leftActivate(corresponding, nullptr, PropagationFlag::RETRACT);
+        }
     }
     else if (flag == PropagationFlag::UPDATE)
     {
@@ -104,31 +110,30 @@ void NoValue::rightActivate(Token::Ptr token, PropagationFlag flag)
         // same corresponding token. If so, we can just stop as the other will
         // already violate the noValue condition
         auto corresponding = getCorresponding(token);
-        auto pRight = getRightParent();
-        for (auto rightToken : *pRight)
-        {
-            if (getCorresponding(rightToken) == corresponding)
-            {
-                return; // yup. this will do.
-            }
-        }
+        auto it = rightCounts_.find(corresponding.get());
+        if (it == rightCounts_.end()) return; // never counted, should not happen.
+        if (--it->second > 0) return; // yup. this will do.
+        rightCounts_.erase(it);
 
         // step 2: well, there was no such token... so if it still is in the
         // left memory we know that only the "noValue" part was retracted,
         // making the "noValue" condition satisfied.
-        auto pLeft = getLeftParent();
-        for (auto leftToken : *pLeft)
+        // (Take the instance stored in the left memory, as the corresponding
+        // token we got from the right one keeps the whole right token alive.)
+        auto leftToken = getLeftParent()->get(corresponding.get());
+        if (leftToken)
         {
-            if (leftToken == corresponding)
-            {
-                // assert it now.
-                auto empty = std::make_shared<EmptyWME>();
-                empty->description_ = "noValue";
-                bmem->leftActivate(leftToken, empty, PropagationFlag::ASSERT);
-                return; // there can be only one such token, as we check by ptr
-            }
+            // assert it now.
+            auto empty = std::make_shared<EmptyWME>();
+            empty->description_ = "noValue";
+            bmem->leftActivate(leftToken, empty, PropagationFlag::ASSERT);
         }
     }
 }
 
+size_t NoValue::getMemoryUsage() const
+{
+    return util::memoryUsage(rightCounts_);
+}
+
 }
@@ -4,6 +4,7 @@
 #include <vector>
 #include <utility>
 #include <algorithm>
+#include <unordered_map>
 
 #include "Node.hpp"
 #include "Util.hpp"
@@ -47,6 +48,22 @@ class NoValue : public BetaBetaNode {
     // map from the longer token to the shorter (right to left)
     Token::Ptr getCorresponding(Token::Ptr);
 
+    /**
+        For every left token, the number of tokens in the right memory that
+        are based on it. Tokens without an entry have no corresponding right
+        tokens and pass the noValue condition. As every right token holds its
+        ancestors alive, the pointers used as keys stay valid as long as the
+        count is not zero.
+    */
+    std::unordered_map<const Token*, size_t> rightCounts_;
+
+protected:
+    /**
+        Rebuilds the counts from the right memory before re-evaluating the
+        contents of the left memory.
+    */
+    void initialize() override;
+
 public:
     using Ptr = std::shared_ptr<NoValue>();
 
@@ -60,9 +77,14 @@ public:
     std::string getDOTAttr() const override;
     std::string toString() const override;
 
+    /**
+        The counts of right tokens
+    */
+    size_t getMemoryUsage() const override;
+
     /**
         ASSERT/UPDATE:
-        Checks if the token is present in the right memory,
+        Checks if the token is counted by the right memory,
         and if not propagates it.
 
         RETRACT:
@@ -72,11 +94,12 @@ public:
 
     /**
         ASSERT/UPDATE:
-        Checks if any token in the output memory is part of this token, and
-        retract it if so.
+        Increments the count of the corresponding left token, and retracts it
+        from the output memory if it was the first.
 
         RETRACT:
-        Checks if any token in the left-memory can now be propagated
+        Decrements the count of the corresponding left token, and propagates
+        it if it was the last and the token is still in the left memory.
     */
     void rightActivate(Token::Ptr, PropagationFlag) override;
 };
@@ -8,6 +8,21 @@ std::string Node::getDOTId() const
     return "\"" + util::ptrToStr(this) + "\"";
 }
 
+size_t Node::getMemoryUsage() const
+{
+    return 0;
+}
+
+NodeStatistics::Counts Node::getStatistics() const
+{
+    return stats_.get();
+}
+
+void Node::resetStatistics()
+{
+    stats_.reset();
+}
+
 Node::~Node()
 {
 }
@@ -5,6 +5,7 @@
 #include <memory>
 
 #include "NodeVisitor.hpp"
+#include "NodeStatistics.hpp"
 
 namespace rete {
 
@@ -44,9 +45,25 @@ public:
     */
     virtual void accept(NodeVisitor&) = 0;
 
+    /**
+        Returns the approximate number of bytes the node allocated to keep data, like the contents
+        of memories or the indexes of joins. Neither the node object itself nor the WMEs are
+        included, as the WMEs are shared between all memories that contain them.
+        The default returns 0, for nodes that do not keep any data.
+    */
+    virtual size_t getMemoryUsage() const;
 
+    /**
+        Returns the counters of activations, checks etc. of this node, see NodeStatistics.
+        They are only recorded while NodeStatistics::isEnabled().
+    */
+    NodeStatistics::Counts getStatistics() const;
+    void resetStatistics();
 
     virtual ~Node();
+
+protected:
+    NodeStatistics stats_;
 };
 
 } /* rete */
@@ -0,0 +1,163 @@
+#include "NodeStatistics.hpp"
+
+namespace rete {
+
+std::atomic<bool> NodeStatistics::enabled_(false);
+std::atomic<bool> NodeStatistics::timing_(false);
+
+NodeStatistics::Counts::Counts()
+    : activations{0, 0, 0}, checks(0), matches(0), tokensCreated(0), tokensRetracted(0),
+      nanoseconds(0)
+{
+}
+
+uint64_t NodeStatistics::Counts::numActivations() const
+{
+    return activations[PropagationFlag::ASSERT] +
+           activations[PropagationFlag::RETRACT] +
+           activations[PropagationFlag::UPDATE];
+}
+
+bool NodeStatistics::Counts::empty() const
+{
+    return numActivations() == 0 && checks == 0 && tokensCreated == 0 &&
+           tokensRetracted == 0 && nanoseconds == 0;
+}
+
+NodeStatistics::Counts& NodeStatistics::Counts::operator += (const Counts& other)
+{
+    for (int i = 0; i < 3; i++) activations[i] += other.activations[i];
+    checks += other.checks;
+    matches += other.matches;
+    tokensCreated += other.tokensCreated;
+    tokensRetracted += other.tokensRetracted;
+    nanoseconds += other.nanoseconds;
+    return *this;
+}
+
+std::string NodeStatistics::Counts::toString() const
+{
+    std::string str;
+    const char* flags[] = { "A", "R", "U" };
+    for (int i = 0; i < 3; i++)
+    {
+        if (!activations[i]) continue;
+        if (!str.empty()) str += "  ";
+        str += std::string(flags[i]) + ": " + std::to_string(activations[i]);
+    }
+
+    if (checks)
+    {
+        if (!str.empty()) str += "\n";
+        str += "checks: " + std::to_string(checks) + "  matches: " + std::to_string(matches);
+    }
+
+    if (tokensCreated || tokensRetracted)
+    {
+        if (!str.empty()) str += "\n";
+        str += "tokens: +" + std::to_string(tokensCreated) +
+               " -" + std::to_string(tokensRetracted);
+    }
+
+    if (nanoseconds)
+    {
+        if (!str.empty()) str += "\n";
+        str += "time: " + std::to_string(nanoseconds / 1000) + "us";
+    }
+
+    return str;
+}
+
+
+void NodeStatistics::Activation::record(NodeStatistics& stats, PropagationFlag flag,
+                                        uint64_t count)
+{
+    stats.activated(flag, count);
+    if (NodeStatistics::isTiming())
+    {
+        timed_ = &stats;
+        start_ = std::chrono::steady_clock::now();
+    }
+}
+
+void NodeStatistics::Activation::stop()
+{
+    timed_->addTime(std::chrono::steady_clock::now() - start_);
+}
+
+
+NodeStatistics::NodeStatistics()
+{
+    reset();
+}
+
+void NodeStatistics::activated(PropagationFlag flag, uint64_t count)
+{
+    activations_[flag].fetch_add(count, std::memory_order_relaxed);
+}
+
+void NodeStatistics::checked(bool match)
+{
+    checks_.fetch_add(1, std::memory_order_relaxed);
+    if (match) matches_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void NodeStatistics::created(uint64_t count)
+{
+    tokensCreated_.fetch_add(count, std::memory_order_relaxed);
+}
+
+void NodeStatistics::retracted(uint64_t count)
+{
+    tokensRetracted_.fetch_add(count, std::memory_order_relaxed);
+}
+
+void NodeStatistics::addTime(std::chrono::steady_clock::duration time)
+{
+    nanoseconds_.fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(time).count(),
+        std::memory_order_relaxed);
+}
+
+NodeStatistics::Counts NodeStatistics::get() const
+{
+    Counts counts;
+    for (int i = 0; i < 3; i++) counts.activations[i] = activations_[i].load();
+    counts.checks = checks_.load();
+    counts.matches = matches_.load();
+    counts.tokensCreated = tokensCreated_.load();
+    counts.tokensRetracted = tokensRetracted_.load();
+    counts.nanoseconds = nanoseconds_.load();
+    return counts;
+}
+
+void NodeStatistics::reset()
+{
+    for (auto& a : activations_) a = 0;
+    checks_ = 0;
+    matches_ = 0;
+    tokensCreated_ = 0;
+    tokensRetracted_ = 0;
+    nanoseconds_ = 0;
+}
+
+void NodeStatistics::setEnabled(bool flag)
+{
+    enabled_ = flag && isCompiledIn();
+}
+
+void NodeStatistics::setTiming(bool flag)
+{
+    timing_ = flag;
+}
+
+bool NodeStatistics::isCompiledIn()
+{
+#ifdef RETE_NODE_STATISTICS
+    return true;
+#else
+    return false;
+#endif
+}
+
+} /* rete */
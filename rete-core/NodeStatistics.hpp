@@ -0,0 +1,158 @@
+#ifndef RETE_NODESTATISTICS_HPP_
+#define RETE_NODESTATISTICS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "defs.hpp"
+
+namespace rete {
+
+/**
+    Counters that tell how much work a node did: How often it was activated with which flag,
+    how many combinations of tokens and wmes it checked (joins, builtins) and how many of them
+    matched, how many tokens it created and retracted (beta memories), and optionally how much
+    time its activations took.
+
+    Recording is compiled in with the RETE_NODE_STATISTICS option, but is disabled by default
+    and must be enabled at runtime through setEnabled(true). The time measurement additionally
+    needs setTiming(true), as reading the clock on every activation is rather expensive. The
+    time is inclusive, i.e. it also contains the time spent in the nodes below, which were
+    activated by the node.
+
+    The counters may be incremented concurrently, e.g. by the threads of
+    JoinNode::rightActivateBatch.
+*/
+class NodeStatistics {
+public:
+    /**
+        A plain copy of the counters.
+    */
+    struct Counts {
+        uint64_t activations[3]; // indexed by PropagationFlag
+        uint64_t checks;
+        uint64_t matches;
+        uint64_t tokensCreated;
+        uint64_t tokensRetracted;
+        uint64_t nanoseconds;
+
+        Counts();
+
+        /**
+            The sum of the activations with any flag
+        */
+        uint64_t numActivations() const;
+
+        /**
+            True if nothing was counted
+        */
+        bool empty() const;
+
+        Counts& operator += (const Counts&);
+
+        /**
+            A short, multi-line description of the non-zero counters, e.g.
+            "A: 10  R: 2\nchecks: 30  matches: 5"
+        */
+        std::string toString() const;
+    };
+
+    /**
+        Records the activation of a node in its statistics, and measures the time until it is
+        destroyed if timing is enabled.
+        Defined inline, so that disabled statistics only cost a check of isEnabled().
+    */
+    class Activation {
+        NodeStatistics* timed_;
+        std::chrono::steady_clock::time_point start_;
+
+        void record(NodeStatistics&, PropagationFlag, uint64_t count);
+        void stop();
+    public:
+        inline Activation(NodeStatistics& stats, PropagationFlag flag, uint64_t count = 1)
+            : timed_(nullptr)
+        {
+            if (NodeStatistics::isEnabled()) record(stats, flag, count);
+        }
+
+        inline ~Activation()
+        {
+            if (timed_) stop();
+        }
+
+        Activation(const Activation&) = delete;
+        Activation& operator = (const Activation&) = delete;
+    };
+
+    NodeStatistics();
+
+    void activated(PropagationFlag, uint64_t count = 1);
+    void checked(bool match);
+    void created(uint64_t count = 1);
+    void retracted(uint64_t count = 1);
+    void addTime(std::chrono::steady_clock::duration);
+
+    /**
+        Returns a copy of the current counters
+    */
+    Counts get() const;
+
+    /**
+        Sets all counters to zero
+    */
+    void reset();
+
+    /**
+        Enables/disables the recording of the statistics of all nodes. Has no effect if the
+        statistics were not compiled in.
+    */
+    static void setEnabled(bool);
+    static inline bool isEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+        Enables/disables the measurement of the time spent in activations, for all nodes.
+        Only takes effect while the statistics are enabled.
+    */
+    static void setTiming(bool);
+    static inline bool isTiming() { return timing_.load(std::memory_order_relaxed); }
+
+    /**
+        True if the library was built with the RETE_NODE_STATISTICS option
+    */
+    static bool isCompiledIn();
+
+private:
+    std::atomic<uint64_t> activations_[3];
+    std::atomic<uint64_t> checks_;
+    std::atomic<uint64_t> matches_;
+    std::atomic<uint64_t> tokensCreated_;
+    std::atomic<uint64_t> tokensRetracted_;
+    std::atomic<uint64_t> nanoseconds_;
+
+    static std::atomic<bool> enabled_;
+    static std::atomic<bool> timing_;
+};
+
+} /* rete */
+
+
+/**
+    Helpers to record statistics inside the nodes, that vanish completely if the statistics are
+    not compiled in. E.g.:
+
+        RETE_NODE_ACTIVATION(stats_, flag);   // at the start of an activation
+        RETE_NODE_STATS(stats_.checked(ok));  // anywhere
+*/
+#ifdef RETE_NODE_STATISTICS
+#define RETE_NODE_STATS(call) \
+    do { if (rete::NodeStatistics::isEnabled()) (call); } while (false)
+#define RETE_NODE_ACTIVATION(stats, ...) \
+    rete::NodeStatistics::Activation rete_node_activation_((stats), __VA_ARGS__)
+#else
+#define RETE_NODE_STATS(call) do { } while (false)
+#define RETE_NODE_ACTIVATION(stats, ...) do { } while (false)
+#endif
+
+#endif /* end of include guard: RETE_NODESTATISTICS_HPP_ */
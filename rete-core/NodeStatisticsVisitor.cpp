@@ -0,0 +1,73 @@
+#include "NodeStatisticsVisitor.hpp"
+#include "AlphaNode.hpp"
+#include "AlphaMemory.hpp"
+#include "BetaNode.hpp"
+#include "BetaMemory.hpp"
+#include "BetaBetaNode.hpp"
+#include "ProductionNode.hpp"
+
+namespace rete {
+
+NodeStatisticsVisitor::NodeStatisticsVisitor(bool reset)
+    : reset_(reset)
+{
+}
+
+void NodeStatisticsVisitor::collect(Node* node)
+{
+    auto p = nodes_.insert({node, NodeStatistics::Counts()});
+    if (!p.second) return; // already counted
+
+    p.first->second = node->getStatistics();
+    total_ += p.first->second;
+    if (reset_) node->resetStatistics();
+}
+
+void NodeStatisticsVisitor::visit(AlphaNode* node)
+{
+    collect(node);
+}
+
+void NodeStatisticsVisitor::visit(AlphaMemory* node)
+{
+    collect(node);
+}
+
+void NodeStatisticsVisitor::visit(BetaNode* node)
+{
+    collect(node);
+}
+
+void NodeStatisticsVisitor::visit(BetaMemory* node)
+{
+    collect(node);
+}
+
+void NodeStatisticsVisitor::visit(BetaBetaNode* node)
+{
+    collect(node);
+}
+
+void NodeStatisticsVisitor::visit(ProductionNode* node)
+{
+    collect(node);
+}
+
+const NodeStatistics::Counts& NodeStatisticsVisitor::total() const
+{
+    return total_;
+}
+
+NodeStatistics::Counts NodeStatisticsVisitor::get(const Node* node) const
+{
+    auto it = nodes_.find(node);
+    if (it == nodes_.end()) return NodeStatistics::Counts();
+    return it->second;
+}
+
+size_t NodeStatisticsVisitor::numNodes() const
+{
+    return nodes_.size();
+}
+
+} /* rete */
@@ -0,0 +1,54 @@
+#ifndef RETE_NODESTATISTICSVISITOR_HPP_
+#define RETE_NODESTATISTICSVISITOR_HPP_
+
+#include <unordered_map>
+
+#include "NodeVisitor.hpp"
+#include "Node.hpp"
+
+namespace rete {
+
+/**
+    Collects the statistics (see NodeStatistics) of the nodes it visits, and sums them up. Like
+    the MemoryUsageVisitor every node is only counted once, so it can be passed to the
+    ParsedRule::accept of one or more rules to find out how much work they caused, or to
+    Network::accept for the whole network.
+
+    If constructed with reset = true, the statistics of the nodes are reset after they have been
+    collected, e.g. to look at them in regular intervals.
+*/
+class NodeStatisticsVisitor : public NodeVisitor {
+    bool reset_;
+    std::unordered_map<const Node*, NodeStatistics::Counts> nodes_;
+    NodeStatistics::Counts total_;
+
+    void collect(Node*);
+public:
+    NodeStatisticsVisitor(bool reset = false);
+
+    void visit(AlphaNode*) override;
+    void visit(AlphaMemory*) override;
+    void visit(BetaNode*) override;
+    void visit(BetaMemory*) override;
+    void visit(BetaBetaNode*) override;
+    void visit(ProductionNode*) override;
+
+    /**
+        The sum of the statistics of all visited nodes
+    */
+    const NodeStatistics::Counts& total() const;
+
+    /**
+        The statistics of a single node, all zero if it was not visited
+    */
+    NodeStatistics::Counts get(const Node*) const;
+
+    /**
+        The number of visited nodes
+    */
+    size_t numNodes() const;
+};
+
+} /* rete */
+
+#endif /* end of include guard: RETE_NODESTATISTICSVISITOR_HPP_ */
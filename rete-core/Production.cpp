@@ -8,6 +8,11 @@ Production::Production(int priority, const std::string& name)
 {
 }
 
+bool Production::isConcurrent() const
+{
+    return false;
+}
+
 int Production::getPriority() const
 {
     return priority_;
@@ -51,6 +51,14 @@ public:
     */
     virtual void execute(Token::Ptr, PropagationFlag, std::vector<WME::Ptr>& inferred) = 0;
 
+    /**
+        Returns true if execute may be called concurrently for different tokens, which requires
+        that it does not modify anything but the given vector, and that its result depends on
+        nothing but the token. Such productions can be executed in parallel by the reasoner.
+        The default implementation returns false.
+    */
+    virtual bool isConcurrent() const;
+
 
     int getPriority() const;
 
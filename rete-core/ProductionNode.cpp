@@ -3,7 +3,7 @@
 
 #include <iostream>
 rete::ProductionNode::ProductionNode(Production::Ptr p)
-    : production_(p), name_("")
+    : production_(p), name_(std::make_shared<const std::string>())
 {
 }
 
@@ -25,10 +25,15 @@ void rete::ProductionNode::initialize()
 
 void rete::ProductionNode::setName(const std::string& name)
 {
-    name_ = name;
+    name_ = std::make_shared<const std::string>(name);
 }
 
 std::string rete::ProductionNode::getName() const
+{
+    return *name_;
+}
+
+std::shared_ptr<const std::string> rete::ProductionNode::getNamePtr() const
 {
     return name_;
 }
@@ -48,3 +53,8 @@ std::string rete::ProductionNode::toString() const
 {
     return "ProductionNode \'" + getName() + "\'\n" + production_->getName();
 }
+
+rete::BetaMemoryPtr rete::ProductionNode::getParent() const
+{
+    return parent_;
+}
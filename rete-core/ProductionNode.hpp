@@ -23,7 +23,12 @@ protected:
     BetaMemoryPtr parent_;
     Production::Ptr production_;
     std::string getDOTAttr() const override;
-    std::string name_;
+
+    /**
+        The name is shared with the items on the agenda, so that they don't
+        need a copy of it each.
+    */
+    std::shared_ptr<const std::string> name_;
     inline void accept(NodeVisitor& visitor) override { visitor.visit(this); }
 public:
     using Ptr = std::shared_ptr<ProductionNode>;
@@ -43,9 +48,15 @@ public:
     */
     void setName(const std::string&);
     std::string getName() const;
+    std::shared_ptr<const std::string> getNamePtr() const;
 
     Production::Ptr getProduction() const;
 
+    /**
+        Get the parent beta memory
+    */
+    BetaMemoryPtr getParent() const;
+
     /**
         Connect a ProductionNode to its beta-memory parent
     */
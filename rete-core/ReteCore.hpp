@@ -12,8 +12,11 @@
 #include "defs.hpp"
 #include "GenericJoin.hpp"
 #include "JoinNode.hpp"
+#include "MemoryUsageVisitor.hpp"
 #include "Network.hpp"
 #include "Node.hpp"
+#include "NodeStatistics.hpp"
+#include "NodeStatisticsVisitor.hpp"
 #include "Production.hpp"
 #include "ProductionNode.hpp"
 #include "Token.hpp"
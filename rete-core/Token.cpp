@@ -1,7 +1,91 @@
 #include "Token.hpp"
+#include "TokenPool.hpp"
 
 namespace rete {
 
+Token::Token()
+    : size_(0), jump_(nullptr)
+{
+}
+
+Token::Ptr Token::create(Token::Ptr parent, WME::Ptr wme)
+{
+    auto token = std::allocate_shared<Token>(PoolAllocator<Token>());
+
+    if (!parent)
+    {
+        token->size_ = 1;
+        token->jump_ = token.get();
+    }
+    else
+    {
+        token->size_ = parent->size() + 1;
+
+        // jump twice as far as the parent if it jumps as far as its jump target, else only to
+        // the parent. Tokens not created through Token::create are only jumped to as parents.
+        Token* p = parent.get();
+        Token* pj = p->jump_;
+        if (p->size_ && pj->size_ &&
+            p->size_ - pj->size_ == pj->size_ - pj->jump_->size_)
+        {
+            token->jump_ = pj->jump_;
+        }
+        else
+        {
+            token->jump_ = p;
+        }
+    }
+
+    token->parent = std::move(parent);
+    token->wme = std::move(wme);
+    return token;
+}
+
+size_t Token::size() const
+{
+    if (size_) return size_;
+
+    // not created through Token::create
+    size_t size = 1;
+    for (Token* t = parent.get(); t; t = t->parent.get()) size++;
+    return size;
+}
+
+Token* Token::ancestor(size_t i) const
+{
+    const Token* t = this;
+    if (size_)
+    {
+        if (i >= size_) return nullptr;
+
+        size_t target = size_ - i;
+        while (t->size_ > target)
+        {
+            t = (t->jump_->size_ >= target ? t->jump_ : t->parent.get());
+        }
+        if (t->size_ == target) return const_cast<Token*>(t);
+
+        // reached a token that was not created through Token::create
+        i = t->size() - target;
+    }
+
+    // not created through Token::create
+    while (i > 0 && t)
+    {
+        t = t->parent.get();
+        i--;
+    }
+    return const_cast<Token*>(t);
+}
+
+Token::Ptr Token::ancestor(const Token::Ptr& token, size_t i)
+{
+    Token* t = token->ancestor(i);
+    if (!t) return nullptr;
+    if (t == token.get()) return token;
+    return Token::Ptr(token, t);
+}
+
 std::string Token::toString() const
 {
     if (parent)
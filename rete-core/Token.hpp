@@ -19,7 +19,49 @@ struct Token {
     Token::Ptr parent;
     WME::Ptr wme;
 
+    Token();
+
     std::string toString() const;
+
+    /**
+        Creates a new token. The token is allocated together with the reference count of the
+        shared_ptr in a single block taken from a pool (see TokenPool.hpp), which is a lot
+        cheaper than two separate heap allocations for every partial match.
+
+        Tokens created this way also know their position in the chain of parents and can access
+        every ancestor in logarithmic time, see ancestor(size_t). Do not change the parent of
+        such a token afterwards.
+    */
+    static Token::Ptr create(Token::Ptr parent, WME::Ptr wme);
+
+    /**
+        Returns the number of WMEs in this token, i.e. the length of the chain of parents
+        including this token.
+    */
+    size_t size() const;
+
+    /**
+        Returns the token i steps up the chain: ancestor(0) is this token, ancestor(1) its
+        parent, and so on. Returns nullptr if the chain is too short.
+
+        Besides its parent every token stores a jump pointer to an ancestor further up the
+        chain, chosen like in a skew-binary random access list (Myers, "An applicative random
+        access stack", 1983): Following the jumps where they do not overshoot, and the parents
+        else, reaches any ancestor in O(log(size)) steps. The pointers are set once in
+        Token::create and never change, so tokens may be read from multiple threads.
+        Tokens not created through Token::create fall back to walking the chain.
+    */
+    Token* ancestor(size_t i) const;
+
+    /**
+        Same as above, but returns a shared_ptr to the ancestor which shares the ownership of
+        the given token (which keeps all its ancestors alive, anyway).
+    */
+    static Token::Ptr ancestor(const Token::Ptr& token, size_t i);
+
+private:
+    size_t size_; // 0 if not created through Token::create
+    Token* jump_;
 };
 
 } /* rete */
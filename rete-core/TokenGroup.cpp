@@ -1,4 +1,7 @@
 #include "TokenGroup.hpp"
+#include "MemoryUsage.hpp"
+
+#include <atomic>
 
 namespace rete {
 
@@ -20,5 +23,58 @@ bool TokenGroup::operator < (const WME& other) const
     return this < &other;
 }
 
+void TokenGroup::Aggregate::update(const Token::Ptr& token)
+{
+    remove(token);
+    add(token);
+}
+
+void TokenGroup::insert(const Token::Ptr& token)
+{
+    if (!token_.insert(token).second) return;
+
+    for (auto& entry : aggregates_)
+    {
+        entry.second->add(token);
+    }
+}
+
+void TokenGroup::erase(const Token::Ptr& token)
+{
+    if (!token_.erase(token)) return;
+
+    for (auto& entry : aggregates_)
+    {
+        entry.second->remove(token);
+    }
+}
+
+void TokenGroup::update(const Token::Ptr& token)
+{
+    if (token_.find(token) == token_.end()) return;
+
+    for (auto& entry : aggregates_)
+    {
+        entry.second->update(token);
+    }
+}
+
+size_t TokenGroup::newAggregateId()
+{
+    static std::atomic<size_t> next(0);
+    return next++;
+}
+
+size_t TokenGroup::hash() const
+{
+    // compared by identity, so hash the identity.
+    return std::hash<const TokenGroup*>()(this);
+}
+
+
+size_t TokenGroup::getMemoryUsage() const
+{
+    return util::memoryUsage(token_) + util::memoryUsage(aggregates_);
+}
 
 }
@@ -2,6 +2,8 @@
 #define RETE_TOKENGROUP_HPP_
 
 #include <set>
+#include <memory>
+#include <unordered_map>
 
 #include "WME.hpp"
 #include "Token.hpp"
@@ -21,11 +23,74 @@ class TokenGroup : public WME {
 public:
     using Ptr = std::shared_ptr<TokenGroup>;
 
+    /**
+        An aggregate over the entries of a group, e.g. the sum of some value
+        in every token. Instead of recomputing it from all entries every time
+        the group changes, the group notifies its aggregates about every single
+        token that is added, removed or updated.
+    */
+    class Aggregate {
+    public:
+        virtual ~Aggregate() = default;
+        virtual void add(const Token::Ptr&) = 0;
+        virtual void remove(const Token::Ptr&) = 0;
+
+        /**
+            Called when the values of a token in the group changed. The default
+            implementation removes and re-adds it.
+        */
+        virtual void update(const Token::Ptr&);
+    };
+
+    /**
+        The entries of the group. Only read them, please -- changes must go
+        through insert/erase/update below to keep the aggregates up to date.
+    */
     std::set<Token::Ptr> token_;
 
+    void insert(const Token::Ptr&);
+    void erase(const Token::Ptr&);
+    void update(const Token::Ptr&);
+
+    /**
+        Returns a new id to register aggregates with. Every user of aggregates
+        (e.g. every builtin node) needs its own id.
+    */
+    static size_t newAggregateId();
+
+    /**
+        Returns the aggregate of type A registered with the given id. If there
+        is none yet, it is constructed with the given arguments and initialized
+        with all current entries of the group.
+    */
+    template <class A, class... Args>
+    A& getAggregate(size_t id, Args&&... args)
+    {
+        auto& aggregate = aggregates_[id];
+        if (!aggregate)
+        {
+            aggregate.reset(new A(std::forward<Args>(args)...));
+            for (auto& token : token_)
+            {
+                aggregate->add(token);
+            }
+        }
+        return static_cast<A&>(*aggregate);
+    }
+
     std::string toString() const override;
     const std::string& type() const override;
     bool operator < (const WME& other) const override;
+    size_t hash() const override;
+
+    /**
+        Returns the approximate number of bytes allocated for the entries and aggregates of the
+        group (without the aggregates own data).
+    */
+    size_t getMemoryUsage() const;
+
+private:
+    std::unordered_map<size_t, std::unique_ptr<Aggregate>> aggregates_;
 };
 
 }
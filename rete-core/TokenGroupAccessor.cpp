@@ -91,21 +91,16 @@ WME::Ptr TokenGroupAccessorForwarder::getWMEFromTokenGroup(WME::Ptr wme) const
     if (tg->token_.empty())
         throw std::exception(); // there must be no empty groups
 
-    auto token = *tg->token_.begin();
-    int count = wrappedAccessor_->index();
-
-    while (count > 0 && token)
-    {
-        token = token->parent;
-        count--;
-    }
+    auto first = *tg->token_.begin();
+    int index = wrappedAccessor_->index();
+    auto token = first->ancestor(index > 0 ? index : 0);
 
     if (!token)
     {
         throw std::out_of_range(
             "Accessor indexes entry " + std::to_string(wrappedAccessor_->index())
-            + " and the token is " + std::to_string(count+1)
-            + " entries short on that.");
+            + " and the token has only " + std::to_string(first->size())
+            + " entries.");
     }
     else
     {
@@ -141,9 +136,10 @@ std::string TokenGroupAccessorForwarder::toString() const
 
 Interpretation<TokenGroup::Ptr>::Interpretation(
         AccessorBase* p,
-        std::function<void(WME::Ptr, TokenGroup::Ptr&)> extr)
+        std::function<void(WME::Ptr, TokenGroup::Ptr&)> extr,
+        std::function<const TokenGroup::Ptr*(const WME&)> ref)
     :
-        InterpretationImpl<TokenGroup::Ptr>(p, extr)
+        InterpretationImpl<TokenGroup::Ptr>(p, extr, ref)
 {
 }
 
@@ -75,7 +75,8 @@ template <>
 class Interpretation<TokenGroup::Ptr> : public InterpretationImpl<TokenGroup::Ptr> {
 public:
     Interpretation(AccessorBase* p,
-                   std::function<void(WME::Ptr, TokenGroup::Ptr&)> extr);
+                   std::function<void(WME::Ptr, TokenGroup::Ptr&)> extr,
+                   std::function<const TokenGroup::Ptr*(const WME&)> ref = nullptr);
 
 
     const AccessorBase* childAccessor() const
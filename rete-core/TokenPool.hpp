@@ -0,0 +1,219 @@
+#ifndef RETE_TOKENPOOL_HPP_
+#define RETE_TOKENPOOL_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace rete {
+
+/**
+    The number of chunks allocated by all BlockPools together. The pools never give their
+    chunks back, so this is what they occupy.
+*/
+inline std::atomic<size_t>& numPoolChunks()
+{
+    static std::atomic<size_t> chunks(0);
+    return chunks;
+}
+
+/**
+    A very simple pool of fixed size memory blocks. Blocks are taken from
+    chunks of ChunkSize blocks and put into a free list when released, so that
+    after a short warm up (allocating) and dropping tokens (or whatever is
+    stored in the pool) does not need to call the general purpose allocator at
+    all.
+
+    Every thread allocates from a pool of its own, hence no locking is
+    required. Every block remembers the pool it belongs to: Blocks released on
+    the owning thread go to its free list directly, blocks released on other
+    threads (e.g. workers or readers of snapshots that drop the last reference
+    to a token) are pushed onto a lock-free stack of the owning pool, which the
+    owner takes over when its free list runs empty. So blocks always return to
+    the pool they were taken from, and a thread that only allocates does not
+    lose its blocks to the threads that release them.
+
+    When a thread ends its pool is kept for the next thread that needs one,
+    together with its chunks and the blocks still in use. The chunks are never
+    given back to the system: The pools grow to the peak number of blocks in
+    use, and keep them for reuse until the process ends.
+*/
+template <size_t Size, size_t Align>
+class BlockPool {
+    struct Pool;
+
+    struct Block {
+        Pool* owner;
+        union Data {
+            Block* next;
+            typename std::aligned_storage<Size, Align>::type storage;
+        } data;
+    };
+
+    static_assert(Align <= alignof(std::max_align_t),
+                  "BlockPool only supports fundamental alignments");
+
+    struct Pool {
+        Block* free = nullptr; // only used by the thread owning the pool
+        std::atomic<Block*> returned; // released by other threads
+        Pool() : returned(nullptr) {}
+    };
+
+    static const size_t ChunkSize = 512;
+
+    static Block* blockOf(void* ptr)
+    {
+        return reinterpret_cast<Block*>(static_cast<char*>(ptr) - offsetof(Block, data));
+    }
+
+    /**
+        Pools of threads that ended, for reuse. Deliberately never destroyed,
+        as blocks may be released until the very end of the process.
+    */
+    static std::mutex& unusedMutex()
+    {
+        static std::mutex* mutex = new std::mutex();
+        return *mutex;
+    }
+
+    static std::vector<Pool*>& unused()
+    {
+        static std::vector<Pool*>* pools = new std::vector<Pool*>();
+        return *pools;
+    }
+
+    /**
+        The pool of the current thread, nullptr if it has none (yet, or any
+        more while the thread ends).
+    */
+    static Pool*& localPool()
+    {
+        static thread_local Pool* pool = nullptr;
+        return pool;
+    }
+
+    /**
+        Hands the pool of a thread over to the unused pools when it ends
+    */
+    struct Release {
+        ~Release()
+        {
+            Pool*& pool = localPool();
+            std::lock_guard<std::mutex> lock(unusedMutex());
+            unused().push_back(pool);
+            pool = nullptr;
+        }
+    };
+
+    static Pool* acquirePool()
+    {
+        Pool*& pool = localPool();
+        if (!pool)
+        {
+            {
+                std::lock_guard<std::mutex> lock(unusedMutex());
+                if (unused().empty())
+                {
+                    pool = new Pool();
+                }
+                else
+                {
+                    pool = unused().back();
+                    unused().pop_back();
+                }
+            }
+            static thread_local Release release;
+            (void) release;
+        }
+        return pool;
+    }
+
+public:
+    static void* allocate()
+    {
+        Pool* pool = acquirePool();
+        if (!pool->free)
+        {
+            pool->free = pool->returned.exchange(nullptr, std::memory_order_acquire);
+        }
+
+        if (!pool->free)
+        {
+            Block* chunk = static_cast<Block*>(::operator new(ChunkSize * sizeof(Block)));
+            for (size_t i = 0; i < ChunkSize; i++)
+            {
+                chunk[i].owner = pool;
+                chunk[i].data.next = (i < ChunkSize - 1 ? &chunk[i+1] : nullptr);
+            }
+            pool->free = chunk;
+            numPoolChunks()++;
+        }
+
+        Block* b = pool->free;
+        pool->free = b->data.next;
+        return &b->data;
+    }
+
+    static void release(void* ptr)
+    {
+        Block* b = blockOf(ptr);
+        Pool* pool = b->owner;
+
+        if (pool == localPool())
+        {
+            b->data.next = pool->free;
+            pool->free = b;
+        }
+        else
+        {
+            // only pushed to by many threads, and only taken as a whole by the owner, so there is
+            // no ABA problem
+            Block* head = pool->returned.load(std::memory_order_relaxed);
+            do
+            {
+                b->data.next = head;
+            }
+            while (!pool->returned.compare_exchange_weak(head, b,
+                                                         std::memory_order_release,
+                                                         std::memory_order_relaxed));
+        }
+    }
+};
+
+
+/**
+    A std-conforming allocator that takes single objects from a BlockPool.
+    Used with std::allocate_shared the object and the control block of the
+    shared_ptr are placed in the same pooled block.
+*/
+template <class T>
+class PoolAllocator {
+    using Pool = BlockPool<sizeof(T), alignof(T)>;
+public:
+    using value_type = T;
+
+    PoolAllocator() = default;
+    template <class U> PoolAllocator(const PoolAllocator<U>&) {}
+
+    T* allocate(size_t n)
+    {
+        if (n == 1) return static_cast<T*>(Pool::allocate());
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n)
+    {
+        if (n == 1) Pool::release(ptr);
+        else ::operator delete(ptr);
+    }
+
+    template <class U> bool operator == (const PoolAllocator<U>&) const { return true; }
+    template <class U> bool operator != (const PoolAllocator<U>&) const { return false; }
+};
+
+} /* rete */
+
+#endif /* include guard: RETE_TOKENPOOL_HPP_ */
@@ -26,6 +26,7 @@ public:
         kind of WMEs.
     */
     void activate(WME::Ptr, PropagationFlag) override;
+    bool isConcurrent() const override { return true; }
 
     /**
         The default implementation of an AlphaNode is to call its own activate
@@ -58,6 +58,14 @@ public:
         }
         throw std::exception(); // should not happen
     }
+
+    size_t hash() const override
+    {
+        // value_ is public and may be changed, so no caching here.
+        size_t seed = std::hash<std::string>()(type());
+        util::tuple_hasher<decltype(value_)>::hash(value_, seed);
+        return seed;
+    }
 };
 
 // use typeid to create a unique name for the tuple type
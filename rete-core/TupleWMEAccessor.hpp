@@ -27,6 +27,12 @@ public:
         value = std::get<I>(wme->value_);
     }
 
+    bool getReference(const TWME& wme, const T*& value) const override
+    {
+        value = &std::get<I>(wme.value_);
+        return true;
+    }
+
     TupleWMEAccessor* clone() const override
     {
         auto acc = new TupleWMEAccessor();
@@ -52,6 +58,12 @@ public:
         value = std::get<I>(wme->value_);
     }
 
+    bool getReference(const TWME& wme, const T*& value) const override
+    {
+        value = &std::get<I>(wme.value_);
+        return true;
+    }
+
     void getValue(std::shared_ptr<TWME> wme, std::string& value) const override
     {
         T v;
@@ -132,6 +132,77 @@ struct is_std_to_string_valid {
                      std::true_type>::value;
 };
 
+/**
+    Helper to check if std::hash<T> can be used to hash values of type T.
+*/
+template <class T>
+struct is_hashable {
+    template <class U>
+    static auto test(const U* u) -> decltype(std::hash<U>()(*u),
+                                             std::true_type());
+
+    template <class U>
+    static std::false_type test(...);
+
+    static constexpr bool value =
+        std::is_same<decltype(is_hashable::test<T>(nullptr)),
+                     std::true_type>::value;
+};
+
+/**
+    Combines a hash value into the given seed, e.g. to compute a single hash
+    over multiple values. (Same as boost::hash_combine)
+*/
+inline void hash_combine(size_t& seed, size_t hash)
+{
+    seed ^= hash + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+/**
+    Hashes the given value with std::hash, if possible. Values of types without a std::hash
+    specialization all get the same hash value, 0.
+*/
+template <typename T>
+typename std::enable_if<is_hashable<T>::value, size_t>::type
+    hash_value(const T& v)
+{
+    return std::hash<T>()(v);
+}
+
+template <typename T>
+typename std::enable_if<not is_hashable<T>::value, size_t>::type
+    hash_value(const T&)
+{
+    return 0;
+}
+
+/**
+    Combines the hash values of all elements of a tuple, see tuple_printer_ below for the
+    recursion scheme.
+*/
+template <class T, size_t Remaining>
+struct tuple_hasher_ {
+    static void hash(const T& t, size_t& seed)
+    {
+        hash_combine(seed,
+            hash_value(std::get<std::tuple_size<T>::value - Remaining>(t)));
+        tuple_hasher_<T, Remaining - 1>::hash(t, seed);
+    }
+};
+
+template <class T>
+struct tuple_hasher_<T, 0> {
+    static void hash(const T&, size_t&) {}
+};
+
+template <class T> struct tuple_hasher {};
+template <typename... Args>
+struct tuple_hasher<std::tuple<Args...>>
+    : tuple_hasher_<std::tuple<Args...>, sizeof...(Args)>
+{
+};
+
+
 /**
     Custom, specializable function to print values. Default used std::to_string.
     Used in tuple-printing-methods.
@@ -1,5 +1,7 @@
 #include "WME.hpp"
 
+#include <functional>
+
 
 namespace rete {
 
@@ -12,6 +14,16 @@ bool WME::operator == (const WME& other) const
     return (this == &other) || (!(*this < other) && !(other < *this));
 }
 
+size_t WME::hash() const
+{
+    return std::hash<std::string>()(type());
+}
+
+std::string WME::getDescription() const
+{
+    return description_;
+}
+
 bool WME::isComputed() const
 {
     return isComputed_;
@@ -2,6 +2,7 @@
 #define RETE_WME_HPP_
 
 #include <memory>
+#include <string>
 
 namespace rete {
 
@@ -32,6 +33,13 @@ public:
      */
     std::string description_;
 
+    /**
+     * Returns the description of the WME. By default this is just the
+     * description_ above, but WMEs whose description is expensive to build
+     * may override this to only generate it when it is actually asked for.
+     */
+    virtual std::string getDescription() const;
+
     using Ptr = std::shared_ptr<WME>;
     WME();
     virtual ~WME() {};
@@ -60,6 +68,16 @@ public:
     */
     virtual bool operator < (const WME& other) const = 0;
 
+    /**
+        A hash value for the WME, used to find identical WMEs without comparing them to every
+        other one (e.g. in the AlphaMemory). WMEs that are equal (see operator ==) must return
+        the same hash value, and it must not change while the WME is stored in the network --
+        which is the same restriction as for the operator < above.
+        The default implementation only hashes the type(), which is correct but lets all WMEs of
+        the same type collide. Please override it.
+    */
+    virtual size_t hash() const;
+
     /**
         Check for equality between two WMEs. First checks the memory addresses, then uses the
         operator < to
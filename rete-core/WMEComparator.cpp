@@ -9,4 +9,14 @@ bool WMEComparator::operator() (const WME::Ptr& a, const WME::Ptr& b) const
     return *a < *b;
 }
 
+size_t WMEHash::operator() (const WME::Ptr& wme) const
+{
+    return wme->hash();
+}
+
+bool WMEEqual::operator() (const WME::Ptr& a, const WME::Ptr& b) const
+{
+    return *a == *b;
+}
+
 } /* rete */
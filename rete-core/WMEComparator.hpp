@@ -14,6 +14,22 @@ public:
     bool operator () (const WME::Ptr& a, const WME::Ptr& b) const;
 };
 
+/**
+    Hashes shared_ptr to WMEs by the pointed at WMEs, see WME::hash().
+*/
+class WMEHash {
+public:
+    size_t operator () (const WME::Ptr& wme) const;
+};
+
+/**
+    Equality check for shared_ptr to WMEs, also comparing the pointed at WMEs.
+*/
+class WMEEqual {
+public:
+    bool operator () (const WME::Ptr& a, const WME::Ptr& b) const;
+};
+
 } /* rete */
 
 
@@ -1,7 +1,14 @@
 #ifndef RETE_BUILTIN_MATHBULK_HPP_
 #define RETE_BUILTIN_MATHBULK_HPP_
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
 #include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 #include "../Builtin.hpp"
 #include "../Accessors.hpp"
@@ -11,23 +18,118 @@
 namespace rete {
 namespace builtin {
 
+/**
+    A sum that values can be added to and removed from again, without
+    drifting away from the sum of the values it currently contains.
+    Integral values are simply added up.
+*/
+template <class NumberType, bool = std::is_floating_point<NumberType>::value>
+class RunningSum {
+    NumberType sum_ = 0;
+public:
+    void add(NumberType val) { sum_ += val; }
+    void remove(NumberType val) { sum_ -= val; }
+    void reset() { sum_ = 0; }
+    bool overflowed() const { return false; }
+    NumberType value() const { return sum_; }
+};
+
+/**
+    Floating point values are summed up in (at least) double precision with
+    Neumaier's compensation, which keeps track of the bits that got lost when
+    adding values of very different magnitudes. Hence e.g. 2^24 + 1 - 2^24
+    results in 1, and not in 0 as with a float that is updated in place.
+
+    Infinite and NaN values are only counted, as they could never be
+    subtracted again. If the sum of finite values overflows, overflowed()
+    is true and the sum must be recomputed from scratch to get rid of it.
+*/
+template <class NumberType>
+class RunningSum<NumberType, true> {
+    using Accumulator = typename std::conditional<
+                            (sizeof(NumberType) > sizeof(double)),
+                            NumberType, double>::type;
+
+    Accumulator sum_ = 0;
+    Accumulator compensation_ = 0;
+    size_t nan_ = 0, posInf_ = 0, negInf_ = 0;
+
+    void accumulate(Accumulator val)
+    {
+        Accumulator t = sum_ + val;
+        if (std::abs(sum_) >= std::abs(val))
+            compensation_ += (sum_ - t) + val;
+        else
+            compensation_ += (val - t) + sum_;
+        sum_ = t;
+    }
+
+    size_t& counter(NumberType val)
+    {
+        if (std::isnan(val)) return nan_;
+        return val > 0 ? posInf_ : negInf_;
+    }
+
+public:
+    void add(NumberType val)
+    {
+        if (std::isfinite(val)) accumulate(val);
+        else counter(val)++;
+    }
+
+    void remove(NumberType val)
+    {
+        if (std::isfinite(val)) accumulate(-static_cast<Accumulator>(val));
+        else counter(val)--;
+    }
+
+    void reset()
+    {
+        sum_ = compensation_ = 0;
+        nan_ = posInf_ = negInf_ = 0;
+    }
+
+    bool overflowed() const
+    {
+        return !std::isfinite(sum_) || !std::isfinite(compensation_);
+    }
+
+    NumberType value() const
+    {
+        if (nan_ || (posInf_ && negInf_)) return std::numeric_limits<NumberType>::quiet_NaN();
+        if (posInf_) return std::numeric_limits<NumberType>::infinity();
+        if (negInf_) return -std::numeric_limits<NumberType>::infinity();
+        if (!std::isfinite(sum_)) return static_cast<NumberType>(sum_);
+        return static_cast<NumberType>(sum_ + compensation_);
+    }
+};
+
+
 /**
     Base class for mathematical bulk-builtins: Math operations that have exactly
     one output variable, and a single token-group input to operate on.
     E.g. to calculate the sum of all values that fulfill some condition, in
     GROUP BY constructions.
+
+    The results are not recomputed from all entries of a group on every
+    change. Instead, every builtin registers an aggregate (see Values below)
+    at the groups it processes, which the group keeps up to date with every
+    single token that is added, removed or updated.
 */
 template <class NumberType>
 class MathBulkBuiltin : public Builtin {
 protected:
+    using Input = PersistentInterpretation<TokenGroup::Ptr>;
+
     MathBulkBuiltin(
             const std::string& name,
             PersistentInterpretation<TokenGroup::Ptr> input)
         :
         Builtin(name),
-        input_(std::move(input))
+        input_(std::make_shared<Input>(std::move(input))),
+        aggregateId_(TokenGroup::newAggregateId())
     {
-        childInput_ = input_.interpretation->getChildInterpretation<NumberType>();
+        childInput_ = input_->interpretation->getChildInterpretation<NumberType>();
         if (!childInput_)
             throw std::invalid_argument(
                     "Accessor does not point to " +
@@ -36,15 +138,160 @@ protected:
     }
 
 
-    PersistentInterpretation<TokenGroup::Ptr> input_; // access to group
+    // access to group. Shared with the aggregates, as they may outlive this
+    // builtin in groups that are still in use by other rules.
+    std::shared_ptr<const Input> input_;
     const Interpretation<NumberType>* childInput_; // single value in token in group
+    const size_t aggregateId_;
+
+    /**
+        The base for the aggregates of the bulk builtins: Remembers the value
+        of every entry in the group, so that derived aggregates only need to
+        handle single values being added and removed.
+    */
+    class Values : public TokenGroup::Aggregate {
+        std::shared_ptr<const Input> input_;
+        const Interpretation<NumberType>* childInput_;
+        std::unordered_map<const Token*, NumberType> values_;
+
+        // a sorted copy of the values for the results, until they change
+        mutable std::shared_ptr<const std::vector<NumberType>> copy_;
+
+    protected:
+        virtual void added(NumberType) = 0;
+        virtual void removed(NumberType) = 0;
+
+        /**
+            The current values of the entries of the group, for aggregates
+            that need to recompute their result from scratch
+        */
+        const std::unordered_map<const Token*, NumberType>& values() const
+        {
+            return values_;
+        }
+
+    public:
+        Values(std::shared_ptr<const Input> input,
+               const Interpretation<NumberType>* childInput)
+            : input_(std::move(input)), childInput_(childInput)
+        {
+        }
+
+        void add(const Token::Ptr& token) override
+        {
+            NumberType val;
+            childInput_->getValue(token, val);
+            values_[token.get()] = val;
+            copy_.reset();
+            added(val);
+        }
+
+        void remove(const Token::Ptr& token) override
+        {
+            auto it = values_.find(token.get());
+            if (it == values_.end()) return;
+
+            removed(it->second);
+            values_.erase(it);
+            copy_.reset();
+        }
+
+        size_t size() const
+        {
+            return values_.size();
+        }
+
+        /**
+            Returns an immutable copy of the current values, in ascending
+            order (NaNs last). The copy is shared by all results that are
+            created until the values change again.
+        */
+        std::shared_ptr<const std::vector<NumberType>> copy() const
+        {
+            if (!copy_)
+            {
+                std::vector<NumberType> values;
+                values.reserve(values_.size());
+                for (auto& entry : values_) values.push_back(entry.second);
+                std::sort(values.begin(), values.end(),
+                    [](NumberType a, NumberType b)
+                    {
+                        return a < b || (a == a && b != b);
+                    });
+                copy_ = std::make_shared<const std::vector<NumberType>>(std::move(values));
+            }
+            return copy_;
+        }
+    };
+
+    /**
+        Keeps the sum of the values of a group, for sum and avg.
+    */
+    class Sum : public Values {
+        mutable RunningSum<NumberType> sum_;
+    protected:
+        void added(NumberType val) override { sum_.add(val); }
+        void removed(NumberType val) override { sum_.remove(val); }
+    public:
+        using Values::Values;
+        NumberType sum() const
+        {
+            if (sum_.overflowed())
+            {
+                sum_.reset();
+                for (auto& entry : this->values()) sum_.add(entry.second);
+            }
+            return sum_.value();
+        }
+    };
+
+    /**
+        The result of a bulk builtin. It keeps a copy of the values it was
+        computed from, so that it is independent of the group that changes
+        later on. Turning them into a description like "sum( 1 2 3 ) = 6" is
+        expensive, though, so it is only done when the description is
+        actually asked for, e.g. in an explanation.
+    */
+    class Result : public TupleWME<NumberType> {
+        std::shared_ptr<const std::vector<NumberType>> values_;
+        std::string name_;
+    public:
+        Result(NumberType value, const Values& values, const std::string& name)
+            : TupleWME<NumberType>(value),
+              values_(values.copy()), name_(name)
+        {
+        }
+
+        std::string getDescription() const override
+        {
+            std::string description = name_ + "( ";
+            for (auto value : *values_)
+            {
+                description += std::to_string(value) + " ";
+            }
+            description += ") = " + std::to_string(std::get<0>(this->value_));
+            return description;
+        }
+    };
+
+    /**
+        Gets the token group from the token, and the aggregate of type A
+        this builtin registered in it.
+    */
+    template <class A>
+    A& getAggregate(const Token::Ptr& token, TokenGroup::Ptr& group) const
+    {
+        input_->interpretation->getValue(token, group);
+        return group->template getAggregate<A>(aggregateId_, input_, childInput_);
+    }
+
 public:
     using Ptr = std::shared_ptr<MathBulkBuiltin>;
 
     std::string getDOTAttr() const override
     {
         std::string s = name() + "(";
-        s += input_.accessor->toString();
+        s += input_->accessor->toString();
         s += ")";
         return "[label=\"" + util::dotEscape(s) + "\"]";
     }
@@ -57,13 +304,15 @@ public:
         else if (o->name() != this->name())
             return false;
         else
-            return *input_.accessor == *o->input_.accessor;
+            return *input_->accessor == *o->input_->accessor;
     }
 };
 
 
 template <class NumberType>
 class SumBulk : public MathBulkBuiltin<NumberType> {
+    using Base = MathBulkBuiltin<NumberType>;
+
 public:
     SumBulk(PersistentInterpretation<TokenGroup::Ptr> input)
         : MathBulkBuiltin<NumberType>("sum", std::move(input))
@@ -72,27 +321,50 @@ public:
 
     WME::Ptr process(Token::Ptr token) override
     {
-        std::string description = "sum( ";
         TokenGroup::Ptr group;
-        this->input_.interpretation->getValue(token, group);
-        NumberType sum = 0;
-        for (auto entry : group->token_)
-        {
-            NumberType val;
-            this->childInput_->getValue(entry, val);
-            sum += val;
-            description += std::to_string(val) + " ";
-        }
-        description += ") = " + std::to_string(sum);
-
-        auto wme = std::make_shared<TupleWME<NumberType>>(sum);
-        wme->description_ = description;
-        return wme;
+        auto& sum = this->template getAggregate<typename Base::Sum>(token, group);
+        return std::make_shared<typename Base::Result>(
+                    sum.sum(), sum, this->name());
     }
 };
 
 template <class NumberType>
 class MulBulk : public MathBulkBuiltin<NumberType> {
+    using Base = MathBulkBuiltin<NumberType>;
+
+    /**
+        New values are simply multiplied to the product. Values cannot be
+        divided out of it again, though: Not without rounding errors, and not
+        at all once the product is 0 or has over- or underflowed. So removals
+        only mark the product as outdated, and it is recomputed from the
+        current values the next time it is needed.
+    */
+    class Product : public Base::Values {
+        mutable NumberType product_ = 1;
+        mutable bool outdated_ = false;
+    protected:
+        void added(NumberType val) override
+        {
+            if (!outdated_) product_ *= val;
+        }
+        void removed(NumberType) override
+        {
+            outdated_ = true;
+        }
+    public:
+        using Base::Values::Values;
+        NumberType value() const
+        {
+            if (outdated_)
+            {
+                product_ = 1;
+                for (auto& entry : this->values()) product_ *= entry.second;
+                outdated_ = false;
+            }
+            return product_;
+        }
+    };
+
 public:
     MulBulk(PersistentInterpretation<TokenGroup::Ptr> input)
         : MathBulkBuiltin<NumberType>("mul", std::move(input))
@@ -101,22 +373,99 @@ public:
 
     WME::Ptr process(Token::Ptr token) override
     {
-        std::string description = "mul( ";
         TokenGroup::Ptr group;
-        this->input_.interpretation->getValue(token, group);
-        NumberType product = 1;
-        for (auto entry : group->token_)
-        {
-            NumberType val;
-            this->childInput_->getValue(entry, val);
-            product *= val;
-            description += std::to_string(val) + " ";
-        }
-        description += ") = " + std::to_string(product);
+        auto& product = this->template getAggregate<Product>(token, group);
+        return std::make_shared<typename Base::Result>(
+                    product.value(), product, this->name());
+    }
+};
+
+/**
+    Keeps the values of a group ordered, to get the minimum and maximum in
+    logarithmic time.
+*/
+template <class NumberType>
+class OrderedBulk : public MathBulkBuiltin<NumberType> {
+protected:
+    using Base = MathBulkBuiltin<NumberType>;
+
+    class Ordered : public Base::Values {
+        std::multiset<NumberType> ordered_;
+    protected:
+        void added(NumberType val) override { ordered_.insert(val); }
+        void removed(NumberType val) override { ordered_.erase(ordered_.find(val)); }
+    public:
+        using Base::Values::Values;
+        const std::multiset<NumberType>& ordered() const { return ordered_; }
+    };
+
+    OrderedBulk(const std::string& name, PersistentInterpretation<TokenGroup::Ptr> input)
+        : MathBulkBuiltin<NumberType>(name, std::move(input))
+    {
+    }
+};
+
+template <class NumberType>
+class MinBulk : public OrderedBulk<NumberType> {
+    using Base = MathBulkBuiltin<NumberType>;
+public:
+    MinBulk(PersistentInterpretation<TokenGroup::Ptr> input)
+        : OrderedBulk<NumberType>("min", std::move(input))
+    {
+    }
+
+    WME::Ptr process(Token::Ptr token) override
+    {
+        TokenGroup::Ptr group;
+        auto& values = this->template getAggregate<
+                            typename OrderedBulk<NumberType>::Ordered>(token, group);
+        if (values.ordered().empty()) return nullptr;
+
+        return std::make_shared<typename Base::Result>(
+                    *values.ordered().begin(), values, this->name());
+    }
+};
+
+template <class NumberType>
+class MaxBulk : public OrderedBulk<NumberType> {
+    using Base = MathBulkBuiltin<NumberType>;
+public:
+    MaxBulk(PersistentInterpretation<TokenGroup::Ptr> input)
+        : OrderedBulk<NumberType>("max", std::move(input))
+    {
+    }
+
+    WME::Ptr process(Token::Ptr token) override
+    {
+        TokenGroup::Ptr group;
+        auto& values = this->template getAggregate<
+                            typename OrderedBulk<NumberType>::Ordered>(token, group);
+        if (values.ordered().empty()) return nullptr;
+
+        return std::make_shared<typename Base::Result>(
+                    *values.ordered().rbegin(), values, this->name());
+    }
+};
+
+template <class NumberType>
+class AvgBulk : public MathBulkBuiltin<NumberType> {
+    using Base = MathBulkBuiltin<NumberType>;
+
+public:
+    AvgBulk(PersistentInterpretation<TokenGroup::Ptr> input)
+        : MathBulkBuiltin<NumberType>("avg", std::move(input))
+    {
+    }
+
+    WME::Ptr process(Token::Ptr token) override
+    {
+        TokenGroup::Ptr group;
+        auto& sum = this->template getAggregate<typename Base::Sum>(token, group);
+        if (sum.size() == 0) return nullptr;
 
-        auto wme = std::make_shared<TupleWME<NumberType>>(product);
-        wme->description_ = description;
-        return wme;
+        return std::make_shared<typename Base::Result>(
+                    sum.sum() / static_cast<NumberType>(sum.size()),
+                    sum, this->name());
     }
 };
 
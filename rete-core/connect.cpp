@@ -42,7 +42,7 @@ void SetParent(BetaNode::Ptr parent, BetaMemory::Ptr child)
     if (child->parent_)
     {
         child->parent_->bmem_.reset();
-        child->tokens_.clear(); // TODO: retract?
+        child->clear(); // TODO: retract?
     }
 
     child->parent_ = parent;
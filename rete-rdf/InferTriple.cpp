@@ -80,5 +80,10 @@ void InferTriple::execute(Token::Ptr token, PropagationFlag flag, std::vector<WM
     }
 }
 
+bool InferTriple::isConcurrent() const
+{
+    return true;
+}
+
 
 } /* rete */
@@ -54,6 +54,11 @@ public:
     */
     void execute(Token::Ptr, PropagationFlag, std::vector<WME::Ptr>&) override;
 
+    /**
+        Only reads the token, so it can be executed concurrently.
+    */
+    bool isConcurrent() const override;
+
 private:
     // keep alive
     ToTriplePartConversion subject_, predicate_, object_;
@@ -5,6 +5,7 @@ namespace rete {
 Skolem::Skolem(const std::string& id)
     : identifier(id)
 {
+    hash_ = std::hash<std::string>()(identifier);
 }
 
 std::string Skolem::toString() const
@@ -34,6 +35,11 @@ bool Skolem::operator < (const WME& other) const
     }
 }
 
+size_t Skolem::hash() const
+{
+    return hash_;
+}
+
 
 
 }
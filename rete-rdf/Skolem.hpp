@@ -8,6 +8,7 @@ namespace rete {
 
 class Skolem : public WME {
     static const std::string type_;
+    size_t hash_;
 public:
     using Ptr = std::shared_ptr<Skolem>;
 
@@ -18,6 +19,7 @@ public:
     std::string toString() const override;
     const std::string& type() const override;
     bool operator < (const WME& other) const override;
+    size_t hash() const override;
 };
 
 }
@@ -0,0 +1,206 @@
+#include "TermDictionary.hpp"
+
+#include <stdexcept>
+#include <type_traits>
+#include <sstream>
+#include <cctype>
+
+namespace rete {
+
+TermDictionary::Term::Term(const std::string& term, ID id)
+    : part_{term}, lexicalBegin_(0), lexicalLength_(term.size()),
+      escaped_(false), number_(0.f), id_(id), references_(0)
+{
+    if (term.size() >= 2 && *term.begin() == '\"' && *term.rbegin() == '\"')
+    {
+        // quoted -> remove the quotes, resolving escape sequences the same
+        // way std::quoted does: read up to the first unescaped quote.
+        lexicalBegin_ = 1;
+        size_t i = 1;
+        for (; i < term.size() && term[i] != '\"'; i++)
+        {
+            if (term[i] == '\\')
+            {
+                if (!escaped_)
+                {
+                    escaped_ = true;
+                    escapedLexical_ = term.substr(1, i-1);
+                }
+                i++;
+                if (i == term.size()) break;
+            }
+            if (escaped_) escapedLexical_ += term[i];
+        }
+        lexicalLength_ = i - 1;
+    }
+    else if (term.size() >= 2 && *term.begin() == '<' && *term.rbegin() == '>')
+    {
+        // a resource -> remove the brackets.
+        lexicalBegin_ = 1;
+        lexicalLength_ = term.size() - 2;
+    }
+
+    // Only bother a stringstream if this could be a number at all. Anything
+    // else would fail to parse and yield 0, anyway.
+    if (lexicalLength_ > 0 || escaped_)
+    {
+        std::string lexical;
+        getLexical(lexical);
+        unsigned char c = lexical.empty() ? 'x' : lexical[0];
+        if (std::isdigit(c) || std::isspace(c) || c == '-' || c == '+' || c == '.')
+        {
+            std::istringstream(lexical) >> number_;
+        }
+    }
+}
+
+const TriplePart& TermDictionary::Term::part() const
+{
+    return part_;
+}
+
+void TermDictionary::Term::getLexical(std::string& value) const
+{
+    if (escaped_) value = escapedLexical_;
+    else value.assign(part_.value, lexicalBegin_, lexicalLength_);
+}
+
+float TermDictionary::Term::getNumber() const
+{
+    return number_;
+}
+
+TermDictionary& TermDictionary::instance()
+{
+    // never destroyed, as triples may still be released during static
+    // destruction
+    static TermDictionary* dictionary = new TermDictionary();
+    return *dictionary;
+}
+
+const std::string& TermDictionary::intern(const std::string& term, ID& id)
+{
+    size_t shardIndex = TermHash()(term) % NumShards;
+    Shard& shard = shards_[shardIndex];
+
+    {
+        // most terms are known already
+        std::shared_lock<std::shared_timed_mutex> lock(shard.mutex_);
+        auto it = shard.terms_.find(std::cref(term));
+        if (it != shard.terms_.end())
+        {
+            it->second->references_.fetch_add(1, std::memory_order_relaxed);
+            id = it->second->id_;
+            return it->first.get();
+        }
+    }
+
+    std::unique_lock<std::shared_timed_mutex> lock(shard.mutex_);
+    auto it = shard.terms_.find(std::cref(term));
+    if (it != shard.terms_.end())
+    {
+        it->second->references_.fetch_add(1, std::memory_order_relaxed);
+        id = it->second->id_;
+        return it->first.get();
+    }
+
+    size_t slot;
+    if (shard.freeSlots_.empty())
+    {
+        slot = shard.slots_.size();
+        shard.slots_.push_back(nullptr);
+    }
+    else
+    {
+        slot = shard.freeSlots_.back();
+        shard.freeSlots_.pop_back();
+    }
+
+    id = slot * NumShards + shardIndex;
+    Term* stored = new Term(term, id);
+    stored->references_ = 1;
+    shard.slots_[slot] = stored;
+    shard.terms_.insert({std::cref(stored->part().value), stored});
+    return stored->part().value;
+}
+
+void TermDictionary::release(const std::string& interned)
+{
+    const Term& term = lookup(interned);
+
+    // as long as it is not the last reference, nothing else needs to be done
+    size_t references = term.references_.load(std::memory_order_relaxed);
+    while (references > 1)
+    {
+        if (term.references_.compare_exchange_weak(references, references - 1,
+                                                   std::memory_order_release,
+                                                   std::memory_order_relaxed))
+        {
+            return;
+        }
+    }
+
+    instance().remove(term);
+}
+
+void TermDictionary::remove(const Term& term)
+{
+    // Decide under the exclusive lock, as nobody can add a reference then: If
+    // the count drops to zero here, it stays there.
+    Shard& shard = shards_[term.id_ % NumShards];
+    std::unique_lock<std::shared_timed_mutex> lock(shard.mutex_);
+    if (term.references_.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+    size_t slot = term.id_ / NumShards;
+    shard.terms_.erase(std::cref(term.part().value));
+    shard.slots_[slot] = nullptr;
+    shard.freeSlots_.push_back(slot);
+    delete &term;
+}
+
+TermDictionary::ID TermDictionary::getID(const std::string& term)
+{
+    ID id;
+    intern(term, id);
+    return id;
+}
+
+const std::string& TermDictionary::getTerm(ID id) const
+{
+    const Shard& shard = shards_[id % NumShards];
+    std::shared_lock<std::shared_timed_mutex> lock(shard.mutex_);
+
+    Term* term = shard.slots_.at(id / NumShards);
+    if (!term) throw std::out_of_range("Unknown term id " + std::to_string(id));
+    return term->part().value;
+}
+
+const TriplePart& TermDictionary::getPart(const std::string& interned)
+{
+    return lookup(interned).part();
+}
+
+const TermDictionary::Term& TermDictionary::lookup(const std::string& interned)
+{
+    // The string is the first (and only) member of the standard layout
+    // TriplePart, which is the first member of the standard layout Term, so
+    // the addresses are interchangeable.
+    static_assert(std::is_standard_layout<TriplePart>::value,
+                  "TriplePart must be standard layout");
+    static_assert(std::is_standard_layout<Term>::value,
+                  "TermDictionary::Term must be standard layout");
+    return *reinterpret_cast<const Term*>(&interned);
+}
+
+size_t TermDictionary::size() const
+{
+    size_t size = 0;
+    for (auto& shard : shards_)
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(shard.mutex_);
+        size += shard.terms_.size();
+    }
+    return size;
+}
+
+} /* rete */
@@ -0,0 +1,169 @@
+#ifndef RETE_RDF_TERMDICTIONARY_HPP_
+#define RETE_RDF_TERMDICTIONARY_HPP_
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "TriplePart.hpp"
+
+namespace rete {
+
+/**
+    The TermDictionary maps every term (IRI, literal, blank node, ...) used in
+    a Triple to a unique integer ID and keeps a single copy of its string.
+    Triples only reference the stored strings and remember the IDs of their
+    parts, so that checks for equality can compare integers instead of (often
+    rather long) strings, and a term used in a million triples is stored only
+    once.
+
+    The terms are stored as TripleParts, so that accessors can hand out
+    references to TripleParts without creating (and copying) new ones.
+    Also, the lexical value (without quotes or angle brackets) and the numeric
+    value of every term are parsed only once, when the term is added.
+
+    There is one global dictionary, as the IDs must be comparable between all
+    triples. The terms are reference counted: Every intern(...) or getID(...)
+    adds a reference that must be given back through release(...) (Triples do
+    that on their own), and a term is removed as soon as it is not referenced
+    anymore. Hence a stream of unique literals (timestamps, measurements, ...)
+    does not let the dictionary grow forever. The IDs of removed terms are
+    reused for new ones.
+
+    The terms are distributed over a number of shards by their hash, each with
+    its own reader-writer lock, so that triples can be created on multiple
+    threads at once: Looking up known terms only takes a shared lock, and only
+    adding or removing a term locks (a part of) the dictionary exclusively.
+*/
+class TermDictionary {
+public:
+    using ID = size_t;
+
+    /**
+        A term in the dictionary, together with its parsed forms.
+    */
+    class Term {
+        // NOTE: part must stay the first member, see TermDictionary::lookup
+        TriplePart part_;
+
+        // the lexical value is either a substring of the term,
+        size_t lexicalBegin_, lexicalLength_;
+        // or, if the literal contained escape sequences, stored separately.
+        bool escaped_;
+        std::string escapedLexical_;
+
+        float number_;
+
+        ID id_;
+        mutable std::atomic<size_t> references_;
+
+        friend class TermDictionary;
+
+    public:
+        Term(const std::string& term, ID id);
+
+        /**
+            The term as it is, e.g. "\"foo\"" or "<http://example.com>".
+        */
+        const TriplePart& part() const;
+
+        /**
+            The lexical value: The term without surrounding quotes (with
+            escape sequences resolved) or angle brackets. Other terms are
+            returned unchanged.
+        */
+        void getLexical(std::string& value) const;
+
+        /**
+            The lexical value parsed as a float (0 if it is not a number).
+        */
+        float getNumber() const;
+    };
+
+    /**
+        Returns the global dictionary.
+    */
+    static TermDictionary& instance();
+
+    /**
+        Adds the term to the dictionary if it is not already known, and adds a
+        reference to it. Returns the stored copy of the term, which stays valid
+        until the reference is released, and sets id to the ID of the term.
+    */
+    const std::string& intern(const std::string& term, ID& id);
+
+    /**
+        Returns the ID of the given term, adding it to the dictionary if
+        neccessary. Adds a reference just like intern(...), which can be
+        released through release(getTerm(id)).
+    */
+    ID getID(const std::string& term);
+
+    /**
+        Releases a reference to the given term, which must have been obtained
+        through intern(...) or getTerm(...). Removes the term from the
+        dictionary if this was the last reference.
+    */
+    static void release(const std::string& interned);
+
+    /**
+        Returns the term with the given ID, which must be referenced. Throws
+        std::out_of_range for unknown IDs.
+    */
+    const std::string& getTerm(ID id) const;
+
+    /**
+        Returns the TriplePart that holds the given term, if the reference
+        was obtained from intern(...), getTerm(...) or the members of a
+        Triple. Constant time and without locking.
+    */
+    static const TriplePart& getPart(const std::string& interned);
+
+    /**
+        Same as getPart, but returns the Term with its parsed forms.
+    */
+    static const Term& lookup(const std::string& interned);
+
+    /**
+        The number of known terms.
+    */
+    size_t size() const;
+
+private:
+    TermDictionary() = default;
+    TermDictionary(const TermDictionary&) = delete;
+    TermDictionary& operator = (const TermDictionary&) = delete;
+
+    struct TermHash {
+        size_t operator () (const std::string& term) const
+        {
+            return std::hash<std::string>()(term);
+        }
+    };
+
+    static const size_t NumShards = 64;
+
+    /**
+        A part of the dictionary. The ID of a term is the index of its slot in
+        the shard times NumShards, plus the index of the shard.
+    */
+    struct Shard {
+        mutable std::shared_timed_mutex mutex_;
+        std::vector<Term*> slots_; // nullptr if free
+        std::vector<size_t> freeSlots_;
+        std::unordered_map<std::reference_wrapper<const std::string>, Term*,
+                           TermHash, std::equal_to<std::string>> terms_;
+    };
+
+    std::array<Shard, NumShards> shards_;
+
+    void remove(const Term&);
+};
+
+} /* rete */
+
+#endif /* include guard: RETE_RDF_TERMDICTIONARY_HPP_ */
@@ -1,12 +1,32 @@
 #include "Triple.hpp"
+#include "../rete-core/Util.hpp"
 
 namespace rete {
 
 Triple::Triple( const std::string& s,
                 const std::string& p,
                 const std::string& o)
-    : subject(s), predicate(p), object(o)
+    : subject(TermDictionary::instance().intern(s, subjectID_)),
+      predicate(TermDictionary::instance().intern(p, predicateID_)),
+      object(TermDictionary::instance().intern(o, objectID_))
 {
+    // the triple is immutable, so just compute the hash once
+    std::hash<TermDictionary::ID> h;
+    hash_ = h(subjectID_);
+    util::hash_combine(hash_, h(predicateID_));
+    util::hash_combine(hash_, h(objectID_));
+}
+
+Triple::Triple(const Triple& other)
+    : Triple(other.subject, other.predicate, other.object)
+{
+}
+
+Triple::~Triple()
+{
+    TermDictionary::release(subject);
+    TermDictionary::release(predicate);
+    TermDictionary::release(object);
 }
 
 const std::string& Triple::getField(Field f) const
@@ -17,6 +37,19 @@ const std::string& Triple::getField(Field f) const
     throw std::exception();
 }
 
+const TriplePart& Triple::getPart(Field f) const
+{
+    return TermDictionary::getPart(getField(f));
+}
+
+TermDictionary::ID Triple::getFieldID(Field f) const
+{
+    if (f == SUBJECT) return subjectID_;
+    if (f == PREDICATE) return predicateID_;
+    if (f == OBJECT) return objectID_;
+    throw std::exception();
+}
+
 
 std::string Triple::toString() const
 {
@@ -35,9 +68,11 @@ bool Triple::operator < (const WME& other) const
 
     if (const Triple* t = dynamic_cast<const Triple*>(&other))
     {
-        if (subject != t->subject) return subject < t->subject;
-        else if (predicate != t->predicate) return predicate < t->predicate;
-        else if (object != t->object) return object < t->object;
+        // equal IDs <=> equal strings. Only compare the strings to keep
+        // the lexicographical order.
+        if (subjectID_ != t->subjectID_) return subject < t->subject;
+        else if (predicateID_ != t->predicateID_) return predicate < t->predicate;
+        else if (objectID_ != t->objectID_) return object < t->object;
         else return false;
     }
 
@@ -45,6 +80,11 @@ bool Triple::operator < (const WME& other) const
     // TODO: I guess I should rely on the type and just static_cast
 }
 
+size_t Triple::hash() const
+{
+    return hash_;
+}
+
 
 std::string Triple::fieldName(Triple::Field f)
 {
@@ -4,20 +4,31 @@
 #include <string>
 
 #include "../rete-core/WME.hpp"
+#include "TermDictionary.hpp"
 
 namespace rete {
 
+/**
+    A Triple-WME. The subject, predicate and object are interned in the global
+    TermDictionary: The members only reference the strings stored there, and
+    equality checks compare the IDs of the terms. The terms are released when
+    the triple is destroyed.
+*/
 class Triple : public WME {
     static const std::string type_;
+    TermDictionary::ID subjectID_, predicateID_, objectID_;
+    size_t hash_;
 public:
     using Ptr = std::shared_ptr<Triple>;
-    const std::string subject;
-    const std::string predicate;
-    const std::string object;
+    const std::string& subject;
+    const std::string& predicate;
+    const std::string& object;
 
     Triple( const std::string& s,
             const std::string& p,
             const std::string& o);
+    Triple(const Triple& other);
+    ~Triple();
 
     enum Field {
         SUBJECT,
@@ -26,11 +37,23 @@ public:
     };
 
     const std::string& getField(Field) const;
+
+    /**
+        Returns the ID of the given field in the TermDictionary.
+    */
+    TermDictionary::ID getFieldID(Field) const;
+
+    /**
+        Returns the given field as a TriplePart, without copying it.
+    */
+    const TriplePart& getPart(Field) const;
+
     std::string toString() const override;
 
     const std::string& type() const override;
 
     bool operator < (const WME& other) const override;
+    size_t hash() const override;
 
     static std::string fieldName(Triple::Field);
 };
@@ -1,6 +1,4 @@
 #include "TripleAccessor.hpp"
-#include <sstream>
-#include <iomanip>
 
 rete::TripleAccessor::TripleAccessor(rete::Triple::Field field)
     : field_(field)
@@ -9,29 +7,9 @@ rete::TripleAccessor::TripleAccessor(rete::Triple::Field field)
 
 void rete::TripleAccessor::getValue(rete::Triple::Ptr wme, std::string& value) const
 {
-    std::string raw = wme->getField(field_);
-    if (raw.size() >= 2 &&
-        *raw.begin() == '\"' &&
-        *raw.rbegin() == '\"')
-    {
-        // quoted -> remove quotes to get the string
-        std::stringstream ss(raw);
-        ss >> std::quoted(value);
-    }
-    else if (raw.size() >= 2 &&
-            *raw.begin() == '<' &&
-            *raw.rbegin() == '>')
-    {
-        // a resource -> remove the brackets.
-        value = raw.substr(1, raw.size()-2);
-    }
-    else
-    {
-        // ... it wasn't really something well formed that should be interpreted
-        // as a string, right? No quotes, no <...>, just.. something. Maybe
-        // a plain number? Whatever. Just output the raw thing.
-        value = raw;
-    }
+    // Quoted strings are unquoted, resources lose their brackets. Anything
+    // else is returned as it is. The TermDictionary did the parsing already.
+    TermDictionary::lookup(wme->getField(field_)).getLexical(value);
 }
 
 
@@ -45,10 +23,7 @@ bool rete::TripleAccessor::equals(const rete::AccessorBase& other) const
 
 void rete::TripleAccessor::getValue(rete::Triple::Ptr wme, float& value) const
 {
-    std::string str;
-    getValue(wme, str);
-
-    std::istringstream(str) >> value;
+    value = TermDictionary::lookup(wme->getField(field_)).getNumber();
 }
 
 void rete::TripleAccessor::getValue(rete::Triple::Ptr wme, TriplePart& value) const
@@ -57,6 +32,13 @@ void rete::TripleAccessor::getValue(rete::Triple::Ptr wme, TriplePart& value) co
 }
 
 
+bool rete::TripleAccessor::getReference(const Triple& wme, const TriplePart*& value) const
+{
+    value = &wme.getPart(field_);
+    return true;
+}
+
+
 std::string rete::TripleAccessor::toString() const
 {
     return "Triple" +
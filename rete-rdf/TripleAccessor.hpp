@@ -24,6 +24,7 @@ public:
     void getValue(Triple::Ptr, std::string& value) const override;
     void getValue(Triple::Ptr, float& value) const override;
     void getValue(Triple::Ptr, TriplePart& value) const override;
+    bool getReference(const Triple&, const TriplePart*& value) const override;
 
     std::string toString() const override;
 
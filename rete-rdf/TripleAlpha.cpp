@@ -4,10 +4,15 @@
 namespace rete {
 
 TripleAlpha::TripleAlpha(Triple::Field f, const std::string& v)
-    : field_(f), value_(v)
+    : field_(f), value_(v), valueID_(TermDictionary::instance().getID(v))
 {
 }
 
+TripleAlpha::~TripleAlpha()
+{
+    TermDictionary::release(TermDictionary::instance().getTerm(valueID_));
+}
+
 void TripleAlpha::activate(WME::Ptr wme, PropagationFlag flag)
 {
     if (flag == PropagationFlag::RETRACT)
@@ -21,7 +26,7 @@ void TripleAlpha::activate(WME::Ptr wme, PropagationFlag flag)
         // already checked the type!
         auto triple = std::static_pointer_cast<Triple>(wme);
 
-        if (triple->getField(field_) == value_) propagate(wme, flag);
+        if (triple->getFieldID(field_) == valueID_) propagate(wme, flag);
     }
     else if (flag == PropagationFlag::UPDATE)
     {
@@ -29,7 +34,7 @@ void TripleAlpha::activate(WME::Ptr wme, PropagationFlag flag)
         // already checked the type!
         auto triple = std::static_pointer_cast<Triple>(wme);
 
-        if (triple->getField(field_) == value_) propagate(wme, PropagationFlag::UPDATE);
+        if (triple->getFieldID(field_) == valueID_) propagate(wme, PropagationFlag::UPDATE);
         else propagate(wme, PropagationFlag::RETRACT);
     }
 }
@@ -40,12 +45,28 @@ bool TripleAlpha::operator == (const AlphaNode& other) const
     if (const TripleAlpha* o = dynamic_cast<const TripleAlpha*>(&other))
     {
         // equivalent if check on same field for same value
-        return (o->field_ == field_) && (o->value_ == value_);
+        return (o->field_ == field_) && (o->valueID_ == valueID_);
     }
     // not even a TripleAlpha node.
     return false;
 }
 
+bool TripleAlpha::getDispatchGroup(size_t& group, size_t& key) const
+{
+    static const size_t base = std::hash<std::string>()("TripleAlpha");
+    group = base + field_;
+    key = valueID_;
+    return true;
+}
+
+bool TripleAlpha::getDispatchKey(WME::Ptr wme, size_t& key) const
+{
+    // same assumption as in activate: a TripleTypeAlpha already checked the type.
+    auto triple = std::static_pointer_cast<Triple>(wme);
+    key = triple->getFieldID(field_);
+    return true;
+}
+
 std::string TripleAlpha::getDOTAttr() const
 {
     std::string field = Triple::fieldName(field_);
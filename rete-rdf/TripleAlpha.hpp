@@ -13,13 +13,23 @@ namespace rete {
 class TripleAlpha : public AlphaNode {
     Triple::Field field_;
     std::string value_;
+    TermDictionary::ID valueID_;
 
     std::string getDOTAttr() const override;
 public:
     TripleAlpha(Triple::Field field, const std::string& value);
+    ~TripleAlpha();
 
     void activate(WME::Ptr, PropagationFlag) override;
     bool operator == (const AlphaNode& other) const override;
+    bool isConcurrent() const override { return true; }
+
+    /**
+        TripleAlphas checking the same field are grouped by their value. Triples are immutable,
+        so this is safe.
+    */
+    bool getDispatchGroup(size_t& group, size_t& key) const override;
+    bool getDispatchKey(WME::Ptr wme, size_t& key) const override;
 
     std::string toString() const override;
 };
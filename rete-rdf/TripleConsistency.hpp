@@ -20,6 +20,7 @@ public:
     TripleConsistency(Triple::Field, Triple::Field);
     void activate(WME::Ptr, PropagationFlag) override;
     bool operator == (const AlphaNode& other) const override;
+    bool isConcurrent() const override { return true; }
 
     std::string toString() const override;
 };
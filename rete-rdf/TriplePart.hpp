@@ -2,6 +2,7 @@
 #define RETE_RDF_TRIPLEPART_HPP_
 
 #include <string>
+#include <functional>
 #include "../rete-core/Util.hpp"
 
 namespace rete {
@@ -18,7 +19,8 @@ struct TriplePart {
 
     bool operator == (const TriplePart& other) const
     {
-        return value == other.value;
+        // interned parts (see TermDictionary) are unique
+        return this == &other || value == other.value;
     }
 };
 
@@ -30,4 +32,18 @@ namespace util {
 
 }
 
+namespace std {
+    /**
+        Hash TripleParts just like their string values, to allow hash-indexed
+        joins on them.
+    */
+    template <>
+    struct hash<rete::TriplePart> {
+        size_t operator () (const rete::TriplePart& part) const
+        {
+            return std::hash<std::string>()(part.value);
+        }
+    };
+}
+
 #endif /* include guard: RETE_RDF_TRIPLEPART_HPP_ */
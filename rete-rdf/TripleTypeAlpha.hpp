@@ -14,6 +14,7 @@ class TripleTypeAlpha : public AlphaNode {
 public:
     void activate(WME::Ptr, PropagationFlag) override;
     bool operator == (const AlphaNode& other) const override;
+    bool isConcurrent() const override { return true; }
 
     std::string toString() const override;
 };
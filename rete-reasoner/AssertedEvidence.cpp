@@ -24,6 +24,11 @@ bool AssertedEvidence::operator<(const Evidence& other) const
     return this->source_ < o->source_;
 }
 
+size_t AssertedEvidence::hash() const
+{
+    return std::hash<std::string>()(source_);
+}
+
 std::string AssertedEvidence::toString() const
 {
     return "Asserted(" + source_ + ")";
@@ -14,6 +14,7 @@ public:
     AssertedEvidence(const std::string&);
     bool operator == (const Evidence& other) const override;
     bool operator < (const Evidence& other) const override;
+    size_t hash() const override;
 
     std::string toString() const override;
 
@@ -1,11 +1,14 @@
 #include "BackedWME.hpp"
 
 #include <algorithm>
+#include <limits>
+
+#include "../rete-core/MemoryUsage.hpp"
 
 namespace rete {
 
-BackedWME::BackedWME(WME::Ptr wme)
-    : wme_(wme)
+BackedWME::BackedWME(WME::Ptr wme, size_t id)
+    : wme_(wme), id_(id), rank_(std::numeric_limits<size_t>::max())
 {
 }
 
@@ -14,6 +17,11 @@ WME::Ptr BackedWME::getWME() const
     return wme_;
 }
 
+size_t BackedWME::getId() const
+{
+    return id_;
+}
+
 bool BackedWME::isBacked() const
 {
     return !evidences_.empty();
@@ -29,6 +37,21 @@ void BackedWME::removeEvidence(Evidence::Ptr e) const
     evidences_.erase(e);
 }
 
+size_t BackedWME::getRank() const
+{
+    return rank_;
+}
+
+void BackedWME::setRank(size_t rank) const
+{
+    rank_ = rank;
+}
+
+size_t BackedWME::getMemoryUsage() const
+{
+    return util::memoryUsage(evidences_);
+}
+
 
 BackedWME::Iterator BackedWME::begin() const
 {
@@ -42,7 +65,12 @@ BackedWME::Iterator BackedWME::end() const
 
 bool BackedWME::SameWME::operator() (const BackedWME& a, const BackedWME& b) const
 {
-    return *a.wme_ < *b.wme_;
+    return *a.wme_ == *b.wme_;
+}
+
+size_t BackedWME::Hash::operator() (const BackedWME& b) const
+{
+    return b.wme_->hash();
 }
 
 } /* rete */
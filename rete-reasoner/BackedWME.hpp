@@ -1,7 +1,7 @@
 #ifndef RETE_BACKEDWME_HPP_
 #define RETE_BACKEDWME_HPP_
 
-#include <set>
+#include <unordered_set>
 
 #include "../rete-core/WME.hpp"
 #include "Evidence.hpp"
@@ -15,14 +15,27 @@ namespace rete {
 class BackedWME {
     const WME::Ptr wme_;
 
+    /**
+        An id that is unique among the WMEs backed in the same InferenceState, and does not
+        change as long as the WME is backed. Allows to index the WMEs by cheap integer keys.
+    */
+    size_t id_;
+
     /**
         BackedWME is used in a set, where it is stored as const. But for the set only the WME matters, not the evidence
     */
-    mutable std::set<Evidence::Ptr, EvidenceComparator> evidences_;
+    mutable std::unordered_set<Evidence::Ptr, EvidenceHash, EvidenceEqual> evidences_;
+
+    /**
+        The support level of the WME, see getRank(). Like the evidences it does not matter for
+        the set.
+    */
+    mutable size_t rank_;
 public:
-    BackedWME(WME::Ptr);
+    BackedWME(WME::Ptr, size_t id = 0);
 
     WME::Ptr getWME() const;
+    size_t getId() const;
 
     /**
         Returns true if there are no evidences for the wrapped WME
@@ -39,6 +52,22 @@ public:
     */
     void removeEvidence(Evidence::Ptr) const;
 
+    /**
+        The rank is the depth of a well-founded derivation of the WME: Asserted WMEs have rank 0,
+        and an inferred WME has a rank higher than all the WMEs in the token of (at least) one of
+        its evidences. Following such an evidence from rank to lower rank always ends at
+        asserted WMEs, which is what allows the Reasoner to detect inference loops without
+        searching the whole graph. The rank is maintained by the Reasoner.
+    */
+    size_t getRank() const;
+    void setRank(size_t) const;
+
+    /**
+        Returns the approximate number of bytes allocated to store the evidences (without the
+        evidences themselves).
+    */
+    size_t getMemoryUsage() const;
+
     /**
         Allow iteration over evidences
     */
@@ -54,6 +83,14 @@ public:
     public:
         bool operator () (const BackedWME& a, const BackedWME& b) const;
     };
+
+    /**
+        Hash a BackedWME by its WME only, to match SameWME
+    */
+    class Hash {
+    public:
+        size_t operator () (const BackedWME& b) const;
+    };
 };
 
 
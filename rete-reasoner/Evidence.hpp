@@ -2,6 +2,8 @@
 #define RETE_EVIDENCE_HPP_
 
 #include <memory>
+#include <functional>
+#include <string>
 
 namespace rete {
 
@@ -27,6 +29,14 @@ public:
     using Ptr = std::shared_ptr<Evidence>;
     virtual bool operator == (const Evidence& other) const = 0;
     virtual bool operator < (const Evidence& other) const = 0;
+
+    /**
+        A hash value for the evidence, used to find equal evidences in hash-based containers.
+        Evidences that are equal (see operator ==) must return the same hash value.
+        The default implementation only hashes the type(), which is correct but lets all
+        evidences of the same type collide. Please override it.
+    */
+    virtual size_t hash() const { return std::hash<int>()(typeId_); }
     virtual ~Evidence() = default;
 
     virtual std::string toString() const = 0;
@@ -11,4 +11,15 @@ bool EvidenceComparator::operator() (const Evidence::Ptr& a, const Evidence::Ptr
     return *a < *b;
 }
 
+size_t EvidenceHash::operator() (const Evidence::Ptr& e) const
+{
+    return e->hash();
+}
+
+bool EvidenceEqual::operator() (const Evidence::Ptr& a, const Evidence::Ptr& b) const
+{
+    if (a == b) return true;
+    return *a == *b;
+}
+
 } /* rete */
@@ -13,6 +13,22 @@ public:
     bool operator () (const Evidence::Ptr& a, const Evidence::Ptr& b) const;
 };
 
+/**
+    Hashes Evidence::Ptr by the actual instances, see Evidence::hash()
+*/
+class EvidenceHash {
+public:
+    size_t operator () (const Evidence::Ptr& e) const;
+};
+
+/**
+    Equality check for Evidence::Ptr, comparing the actual instances
+*/
+class EvidenceEqual {
+public:
+    bool operator () (const Evidence::Ptr& a, const Evidence::Ptr& b) const;
+};
+
 } /* rete */
 
 #endif /* end of include guard: RETE_EVIDENCECOMPARATOR_HATORP_ */
@@ -181,20 +181,16 @@ std::vector<WME::Ptr> getReferencedWMEs(const Annotation& annotation, Token::Ptr
 {
     // traverse token and reference all WMEs that belong to this annotation
     std::vector<WME::Ptr> wmes;
-    size_t index = 0;
     size_t indexBegin = annotation.tokenIndexBegin_;
     size_t indexEnd = annotation.tokenIndexEnd_;
 
     std::cout << "getting based_on wme-ids. range " << indexBegin << " - " << indexEnd << std::endl;
 
-    while (token && index < indexEnd)
+    for (size_t index = indexBegin; token && index < indexEnd; index++)
     {
-        if (index >= indexBegin)
-        {
-            wmes.push_back(token->wme);
-        }
-        index++;
-        token = token->parent;
+        Token* t = token->ancestor(index);
+        if (!t) break;
+        wmes.push_back(t->wme);
     }
 
     return wmes;
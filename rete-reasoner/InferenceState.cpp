@@ -1,7 +1,141 @@
 #include "InferenceState.hpp"
+#include "InferredEvidence.hpp"
+#include "../rete-core/MemoryUsage.hpp"
 
 namespace rete {
 
+void SupportedWMEs::add(size_t id, WME::Ptr wme)
+{
+    auto p = positions_.insert({id, wmes_.size()});
+    if (p.second)
+    {
+        wmes_.push_back(wme);
+        ids_.push_back(id);
+    }
+}
+
+void SupportedWMEs::remove(size_t id)
+{
+    auto it = positions_.find(id);
+    if (it == positions_.end()) return;
+
+    // move the last one into the gap
+    size_t position = it->second;
+    positions_.erase(it);
+    if (position != wmes_.size() - 1)
+    {
+        wmes_[position] = std::move(wmes_.back());
+        ids_[position] = ids_.back();
+        positions_[ids_[position]] = position;
+    }
+    wmes_.pop_back();
+    ids_.pop_back();
+}
+
+const std::vector<WME::Ptr>& SupportedWMEs::wmes() const
+{
+    return wmes_;
+}
+
+size_t SupportedWMEs::getMemoryUsage() const
+{
+    return util::memoryUsage(wmes_) + util::memoryUsage(ids_) + util::memoryUsage(positions_);
+}
+
+namespace {
+
+/**
+    Copies tokens, the token groups in them and inferred evidences, each only once
+*/
+class Freezer {
+    std::unordered_map<const Token*, Token::Ptr> tokens_;
+    std::unordered_map<const WME*, WME::Ptr> groups_;
+    std::unordered_map<const Evidence*, Evidence::Ptr> evidences_;
+
+public:
+    Token::Ptr token(const Token::Ptr& token)
+    {
+        if (!token) return nullptr;
+
+        // (references to the entries of an unordered_map stay valid when it grows)
+        auto& frozen = tokens_[token.get()];
+        if (!frozen) frozen = Token::create(this->token(token->parent), wme(token->wme));
+        return frozen;
+    }
+
+    WME::Ptr wme(const WME::Ptr& wme)
+    {
+        auto group = dynamic_cast<const TokenGroup*>(wme.get());
+        if (!group) return wme;
+
+        auto& frozen = groups_[group];
+        if (!frozen)
+        {
+            auto copy = std::make_shared<TokenGroup>();
+            for (auto& t : group->token_)
+            {
+                copy->insert(token(t));
+            }
+            frozen = copy;
+        }
+        return frozen;
+    }
+
+    Evidence::Ptr evidence(const Evidence::Ptr& evidence)
+    {
+        if (evidence->type() != InferredEvidence::TypeId) return evidence;
+
+        auto& frozen = evidences_[evidence.get()];
+        if (!frozen)
+        {
+            auto inferred = std::static_pointer_cast<InferredEvidence>(evidence);
+            frozen = std::make_shared<InferredEvidence>(
+                            token(inferred->token()), inferred->production());
+        }
+        return frozen;
+    }
+};
+
+}
+
+void InferenceState::freeze()
+{
+    Freezer freezer;
+
+    for (auto& backed : backedWMEs_)
+    {
+        std::vector<Evidence::Ptr> evidences(backed.begin(), backed.end());
+        for (auto& evidence : evidences)
+        {
+            auto frozen = freezer.evidence(evidence);
+            if (frozen != evidence)
+            {
+                backed.removeEvidence(evidence);
+                backed.addEvidence(frozen);
+            }
+        }
+    }
+
+    decltype(evidenceToWME_) evidenceToWME;
+    evidenceToWME.reserve(evidenceToWME_.size());
+    for (auto& entry : evidenceToWME_)
+    {
+        evidenceToWME.emplace(freezer.evidence(entry.first), std::move(entry.second));
+    }
+    evidenceToWME_.swap(evidenceToWME);
+
+    for (auto& entry : dependents_)
+    {
+        std::unordered_set<Evidence::Ptr> evidences;
+        evidences.reserve(entry.second.size());
+        for (auto& evidence : entry.second)
+        {
+            evidences.insert(freezer.evidence(evidence));
+        }
+        entry.second.swap(evidences);
+    }
+}
+
 WMESupportedBy InferenceState::explain(WME::Ptr wme) const
 {
     WMESupportedBy support;
@@ -22,7 +156,7 @@ EvidenceSupports InferenceState::explainedBy(Evidence::Ptr evidence) const
     auto it = evidenceToWME_.find(evidence);
     if (it != evidenceToWME_.end())
     {
-        support.wmes_.insert(support.wmes_.begin(), it->second.begin(), it->second.end());
+        support.wmes_ = it->second.wmes();
     }
 
     return support;
@@ -39,6 +173,34 @@ size_t InferenceState::numEvidences() const
 }
 
 
+size_t InferenceState::getMemoryUsage() const
+{
+    size_t bytes = util::memoryUsage(backedWMEs_)
+                 + util::memoryUsage(evidenceToWME_)
+                 + util::memoryUsage(dependents_);
+
+    for (auto& backed : backedWMEs_)
+    {
+        bytes += backed.getMemoryUsage();
+    }
+
+    for (auto& entry : evidenceToWME_)
+    {
+        bytes += entry.second.getMemoryUsage();
+        if (entry.first->type() == InferredEvidence::TypeId)
+        {
+            bytes += util::sharedMemoryUsage<InferredEvidence>();
+        }
+    }
+
+    for (auto& entry : dependents_)
+    {
+        bytes += util::memoryUsage(entry.second);
+    }
+
+    return bytes;
+}
+
 std::vector<WME::Ptr> InferenceState::getWMEs() const
 {
     std::vector<WME::Ptr> wmes;
@@ -2,8 +2,9 @@
 #define RETE_REASONER_INFERENCE_STATE_HPP_
 
 #include <vector>
-#include <map>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "../rete-core/WME.hpp"
 #include "../rete-core/Token.hpp"
@@ -33,14 +34,44 @@ struct EvidenceSupports {
     std::vector<WME::Ptr> wmes_;
 };
 
+/**
+    The WMEs backed by a single evidence. WMEs can be added and removed in constant time, using
+    the ids of their BackedWMEs (see BackedWME::getId()).
+*/
+class SupportedWMEs {
+    std::vector<WME::Ptr> wmes_;
+    std::vector<size_t> ids_; // the ids of the BackedWMEs, parallel to wmes_
+    std::unordered_map<size_t, size_t> positions_; // id -> index in wmes_
+public:
+    /**
+        Adds the WME with the given id, if it is not already in here
+    */
+    void add(size_t id, WME::Ptr wme);
+
+    /**
+        Removes the WME with the given id. The order of the remaining WMEs may change.
+    */
+    void remove(size_t id);
+
+    const std::vector<WME::Ptr>& wmes() const;
+
+    size_t getMemoryUsage() const;
+};
+
 /**
     The InferenceState keeps information about the current state of the inference graph -- which
     WME was inferred through which rules and tokens, etc.
     It can be copied to get a snapshot of the reasoners state. Be aware that it only contains
     pointers to the WMEs and Evidences involved. In most cases this should not be a problem, since
-    the rete network requires the WMEs to be immutable either way.
+    the rete network requires the WMEs to be immutable either way. But the tokens of inferred
+    evidences are those of the network, which changes some of them in place: The results of
+    builtins are replaced in their tokens, and token groups change with their entries. See
+    freeze() for a copy that is independent of the network.
 
     (Introduced to keep ExplanationIterators valid)
+
+    None of the const methods modify the state, so a state that is not modified anymore (like
+    the snapshots published by the Reasoner) can be read from multiple threads at once.
 */
 class InferenceState {
     friend class Reasoner;
@@ -48,15 +79,36 @@ class InferenceState {
     /**
         The set of WMEs backed by some evidence
     */
-    std::set<BackedWME, BackedWME::SameWME> backedWMEs_;
+    std::unordered_set<BackedWME, BackedWME::Hash, BackedWME::SameWME> backedWMEs_;
+
+    /**
+        The id for the next WME that is backed
+    */
+    size_t nextWMEId_ = 0;
 
     /**
         Index to easily find all WMEs that are backed by a given evidence.
     */
-    std::map<Evidence::Ptr, std::vector<WME::Ptr>, EvidenceComparator> evidenceToWME_;
+    std::unordered_map<Evidence::Ptr, SupportedWMEs, EvidenceHash, EvidenceEqual> evidenceToWME_;
+
+    /**
+        The other direction of the inference graph: Index to find all inferred evidences (the
+        instances used as keys in evidenceToWME_) whose token contains a given backed WME, i.e.,
+        which depend on it.
+    */
+    std::unordered_map<const WME*, std::unordered_set<Evidence::Ptr>> dependents_;
+
+    /**
+        Replaces the tokens of the inferred evidences, and the token groups in them, by copies.
+        Afterwards the state shares nothing with the network that the network changes later on,
+        except for WMEs that are changed in place and announced through an UPDATE, which only
+        user-defined WMEs do. The inferred evidences are replaced by equivalent ones, too, which
+        only compare equal among each other.
+        Prefixes that are shared by the tokens are copied only once, but this still costs about
+        as much as the tokens of the productions in the network.
+    */
+    void freeze();
 
-    // list of WMEs already explained or queued for explanation
-    mutable std::set<WME::Ptr> explained_;
     // helper methods for traverseExplanation
     void traverse(WME::Ptr, ExplanationVisitor&, size_t depth) const;
     void traverse(Evidence::Ptr, ExplanationVisitor&, size_t depth) const;
@@ -84,6 +136,13 @@ public:
 
     /** Returns all WMEs */
     std::vector<WME::Ptr> getWMEs() const;
+
+    /**
+        Returns the approximate number of bytes used by the state: The indexes, and the
+        InferredEvidences. The WMEs and AssertedEvidences are not included, as they are shared
+        with the network and the outside world.
+    */
+    size_t getMemoryUsage() const;
 };
 
 }
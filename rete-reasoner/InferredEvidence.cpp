@@ -3,6 +3,8 @@
 #include <string>
 #include <sstream>
 
+#include "../rete-core/Util.hpp"
+
 namespace rete {
 
 std::string ptostr(const void* ptr)
@@ -42,6 +44,14 @@ bool InferredEvidence::operator<(const Evidence& other) const
     return false;
 }
 
+size_t InferredEvidence::hash() const
+{
+    // same as the comparisons: just the pointers
+    size_t seed = std::hash<Production*>()(production_.get());
+    util::hash_combine(seed, std::hash<Token*>()(token_.get()));
+    return seed;
+}
+
 std::string InferredEvidence::toString() const
 {
     return "[" + ptostr(this) + "] Inferred by [" + ptostr(production_.get()) + "] " + production_->getName() + " from [" + ptostr(token_.get()) + "] " + token_->toString();
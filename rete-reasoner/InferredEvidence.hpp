@@ -15,6 +15,7 @@ public:
     InferredEvidence(const Token::Ptr& token, const Production::Ptr& production);
     bool operator == (const Evidence& other) const override;
     bool operator < (const Evidence& other) const override;
+    size_t hash() const override;
 
     std::string toString() const override;
 
@@ -1,5 +1,12 @@
 #include "ParsedRule.hpp"
 #include "../rete-core/connect.hpp"
+#include "../rete-core/AlphaNode.hpp"
+#include "../rete-core/AlphaMemory.hpp"
+#include "../rete-core/BetaNode.hpp"
+#include "../rete-core/BetaBetaNode.hpp"
+#include "../rete-core/BetaMemory.hpp"
+
+#include <unordered_set>
 
 namespace rete {
 
@@ -44,4 +51,47 @@ void ParsedRule::disconnect()
 }
 
 
+void ParsedRule::accept(NodeVisitor& visitor) const
+{
+    std::unordered_set<Node*> visited;
+    std::vector<Node::Ptr> toVisit(effectNodes_.begin(), effectNodes_.end());
+
+    while (!toVisit.empty())
+    {
+        auto node = toVisit.back();
+        toVisit.pop_back();
+        if (!node || !visited.insert(node.get()).second) continue;
+
+        node->accept(visitor);
+
+        // go upwards
+        if (auto production = std::dynamic_pointer_cast<ProductionNode>(node))
+        {
+            toVisit.push_back(production->getParent());
+        }
+        else if (auto bmem = std::dynamic_pointer_cast<BetaMemory>(node))
+        {
+            toVisit.push_back(bmem->getParent());
+        }
+        else if (auto betabeta = std::dynamic_pointer_cast<BetaBetaNode>(node))
+        {
+            toVisit.push_back(betabeta->getLeftParent());
+            toVisit.push_back(betabeta->getRightParent());
+        }
+        else if (auto beta = std::dynamic_pointer_cast<BetaNode>(node))
+        {
+            toVisit.push_back(beta->getParentBeta());
+            toVisit.push_back(beta->getParentAlpha());
+        }
+        else if (auto amem = std::dynamic_pointer_cast<AlphaMemory>(node))
+        {
+            toVisit.push_back(amem->getParent());
+        }
+        else if (auto alpha = std::dynamic_pointer_cast<AlphaNode>(node))
+        {
+            toVisit.push_back(alpha->getParent());
+        }
+    }
+}
+
 }
@@ -54,6 +54,15 @@ public:
         disconnect the rule at some point, use this method.
     */
     void disconnect();
+
+    /**
+        Lets every node the rule is built of accept the visitor, i.e. the production nodes of
+        the rule and all nodes above them, up to the root of the network. Every node is visited
+        once. Many of these nodes may be shared with other rules.
+
+        E.g., use a MemoryUsageVisitor to find out how much memory the rule needs.
+    */
+    void accept(NodeVisitor&) const;
 };
 
 
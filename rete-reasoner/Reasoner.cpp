@@ -2,11 +2,16 @@
 
 #include "InferredEvidence.hpp"
 #include "AssertedEvidence.hpp"
+#include "../rete-core/MemoryUsage.hpp"
 
 #include <stdexcept>
 #include <iostream>
 #include <algorithm>
 #include <sstream>
+#include <exception>
+#include <thread>
+#include <queue>
+#include <limits>
 
 namespace rete {
 
@@ -48,11 +53,43 @@ InferenceState Reasoner::getCurrentState() const
     return state_;
 }
 
+void Reasoner::publishSnapshot()
+{
+    auto state = std::make_shared<InferenceState>(state_);
+    state->freeze();
+
+    std::shared_ptr<const InferenceState> snapshot = std::move(state);
+    std::atomic_store(&snapshot_, snapshot);
+}
+
+std::shared_ptr<const InferenceState> Reasoner::getSnapshot() const
+{
+    return std::atomic_load(&snapshot_);
+}
+
 void Reasoner::setCallback(std::function<void(WME::Ptr, rete::PropagationFlag)> fn)
 {
     callback_ = fn;
 }
 
+size_t Reasoner::getMemoryUsage() const
+{
+    return rete_.getMemoryUsage()
+         + state_.getMemoryUsage()
+         + util::memoryUsage(history_);
+}
+
+void Reasoner::setNumThreads(size_t threads)
+{
+    numThreads_ = (threads > 0 ? threads : 1);
+}
+
+void Reasoner::addToHistory(const AgendaItem& item)
+{
+    history_.push_back(item);
+    if (history_.size() > maxHistorySize_) history_.erase(history_.begin());
+}
+
 void Reasoner::performInferenceStep()
 {
     auto agenda = rete_.getAgenda();
@@ -61,18 +98,22 @@ void Reasoner::performInferenceStep()
     auto item = agenda->front();
 
     // update history
-    history_.push_back(item);
-    if (history_.size() > maxHistorySize_) history_.erase(history_.begin());
+    addToHistory(item);
 
     agenda->pop_front();
 
+    std::vector<WME::Ptr> inferred;
+    std::get<1>(item)->execute(std::get<0>(item), std::get<2>(item), inferred);
+
+    processInferred(item, inferred);
+}
+
+void Reasoner::processInferred(const AgendaItem& item, std::vector<WME::Ptr>& inferred)
+{
     Token::Ptr token = std::get<0>(item);
     Production::Ptr production = std::get<1>(item);
     PropagationFlag flag = std::get<2>(item);
 
-    std::vector<WME::Ptr> inferred;
-    production->execute(token, flag, inferred);
-
     if (flag == rete::ASSERT)
     {
         // allow inferred WMEs
@@ -144,6 +185,82 @@ void Reasoner::performInferenceStep()
     }
 }
 
+// how many agenda items every thread executes in a round of concurrent inference steps
+static const size_t itemsPerThread = 64;
+
+size_t Reasoner::performConcurrentInferenceSteps(size_t maxSteps)
+{
+    auto agenda = rete_.getAgenda();
+
+    // only a run of ASSERTs of concurrent productions at the front of the agenda
+    std::vector<AgendaItem> items;
+    agenda->front(maxSteps, items);
+    items.erase(
+        std::find_if(items.begin(), items.end(),
+            [](const AgendaItem& item)
+            {
+                return std::get<2>(item) != rete::ASSERT || !std::get<1>(item)->isConcurrent();
+            }),
+        items.end()
+    );
+    if (items.size() < 2) return 0;
+
+    // execute the productions
+    std::vector<std::vector<WME::Ptr>> inferred(items.size());
+    std::vector<std::exception_ptr> errors(items.size());
+    size_t threads = std::min(numThreads_, items.size());
+
+    auto execute = [&](size_t first)
+    {
+        for (size_t i = first; i < items.size(); i += threads)
+        {
+            try
+            {
+                std::get<1>(items[i])->execute(std::get<0>(items[i]), rete::ASSERT, inferred[i]);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; t++)
+    {
+        workers.emplace_back(execute, t);
+    }
+    execute(0);
+    for (auto& worker : workers) worker.join();
+
+    // Process the results in order, but only as long as the items are still the next ones on
+    // the agenda: The results of the previous items may have changed the agenda, e.g. removed a
+    // match through a noValue condition, or added something with a higher priority. The
+    // remaining items are left on the agenda and executed again later.
+    size_t steps = 0;
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        if (agenda->empty()) break;
+
+        auto next = agenda->front();
+        if (std::get<0>(next) != std::get<0>(items[i]) ||
+            std::get<1>(next) != std::get<1>(items[i]) ||
+            std::get<2>(next) != std::get<2>(items[i]))
+        {
+            break;
+        }
+
+        addToHistory(items[i]);
+        agenda->pop_front();
+
+        if (errors[i]) std::rethrow_exception(errors[i]);
+        processInferred(items[i], inferred[i]);
+        steps++;
+    }
+
+    return steps;
+}
+
 void Reasoner::performInference(size_t maxSteps)
 {
     auto agenda = rete_.getAgenda();
@@ -151,8 +268,21 @@ void Reasoner::performInference(size_t maxSteps)
     size_t step = 0;
     while (!agenda->empty())
     {
-        performInferenceStep();
-        step++;
+        size_t steps = 0;
+        if (numThreads_ > 1)
+        {
+            // don't do more steps than allowed, to stop at the same point as without threads
+            size_t limit = numThreads_ * itemsPerThread;
+            if (maxSteps) limit = std::min(limit, maxSteps + 1 - step);
+            steps = performConcurrentInferenceSteps(limit);
+        }
+
+        if (steps == 0)
+        {
+            performInferenceStep();
+            steps = 1;
+        }
+        step += steps;
 
         if (maxSteps && step > maxSteps)
         {
@@ -177,24 +307,56 @@ void Reasoner::performInference(size_t maxSteps)
 }
 
 
-void Reasoner::addEvidence(WME::Ptr wme, Evidence::Ptr evidence)
+// the rank of WMEs and evidences that do not hold
+static const size_t noRank = std::numeric_limits<size_t>::max();
+
+bool Reasoner::backWME(WME::Ptr wme, Evidence::Ptr evidence)
 {
-    BackedWME nBacked(wme);
-    auto p = state_.backedWMEs_.insert(nBacked);
+    auto p = state_.backedWMEs_.emplace(wme, state_.nextWMEId_);
     p.first->addEvidence(evidence); // whether new or old, add the evidence.
 
+    // remember that the evidence is used to back the WME (indexing)
+    auto index = state_.evidenceToWME_.emplace(evidence, SupportedWMEs());
+    index.first->second.add(p.first->getId(), p.first->getWME());
+    if (index.second) indexDependencies(index.first->first);
+
+    if (!p.second)
+    {
+        // A re-derivation of a known WME. The rank it already has stays valid, as the evidence
+        // it is based on is still there -- only the evidence had to be added.
+        return false;
+    }
+
+    // its a new WME!
+    state_.nextWMEId_++;
+    p.first->setRank(evidenceRank(evidence, {}));
+
     // callback
-    if (p.second)
+    if(callback_) callback_(wme, rete::ASSERT);
+    return true;
+}
+
+void Reasoner::addEvidence(WME::Ptr wme, Evidence::Ptr evidence)
+{
+    // announce new WMEs to rete. Known WMEs are already in there, every alpha memory would just
+    // discard them as duplicates.
+    if (backWME(wme, evidence))
     {
-        // its a new WME!
-        if(callback_) callback_(wme, rete::ASSERT);
+        rete_.getRoot()->activate(wme, rete::ASSERT);
     }
+}
 
-    // remember that the evidence is used to back the WME (indexing)
-    state_.evidenceToWME_[evidence].push_back(wme);
+void Reasoner::addEvidence(const std::vector<std::pair<WME::Ptr, Evidence::Ptr>>& evidences)
+{
+    std::vector<WME::Ptr> wmes;
+    wmes.reserve(evidences.size());
+    for (auto& entry : evidences)
+    {
+        if (backWME(entry.first, entry.second)) wmes.push_back(entry.first);
+    }
 
-    // announce to rete
-    rete_.getRoot()->activate(wme, rete::ASSERT);
+    // announce the new WMEs to rete, all at once
+    rete_.getRoot()->activateBatch(wmes, rete::ASSERT, numThreads_);
 }
 
 void Reasoner::removeEvidence(Evidence::Ptr evidence)
@@ -208,19 +370,30 @@ void Reasoner::removeEvidence(Evidence::Ptr evidence)
     {
         // completely remove the evidence from the index, but we still need to work with all the
         // WMEs that are backed by it. Removing the entry before iterating shortens the checks in
-        // removeEvidence(wme, evidence) when the index is updated.
-        std::vector<WME::Ptr> wmes;
-        it->second.swap(wmes);
+        // detachEvidence when the index is updated.
+        std::vector<WME::Ptr> wmes = it->second.wmes();
+        unindexDependencies(it->first);
         state_.evidenceToWME_.erase(it);
 
+        // check the WMEs that still have evidences left all at once, so that parts of the
+        // inference graph they share are only visited once.
+        std::vector<WME::Ptr> stillBacked;
         for (auto wme : wmes)
         {
-            removeEvidence(wme, evidence);
+            detachEvidence(wme, evidence, stillBacked);
         }
+        cleanupInferenceLoops(stillBacked);
     }
 }
 
 void Reasoner::removeEvidence(WME::Ptr wme, Evidence::Ptr evidence)
+{
+    std::vector<WME::Ptr> stillBacked;
+    detachEvidence(wme, evidence, stillBacked);
+    cleanupInferenceLoops(stillBacked);
+}
+
+void Reasoner::detachEvidence(WME::Ptr wme, Evidence::Ptr evidence, std::vector<WME::Ptr>& stillBacked)
 {
     BackedWME nBacked(wme);
     auto it = state_.backedWMEs_.find(nBacked);
@@ -232,13 +405,7 @@ void Reasoner::removeEvidence(WME::Ptr wme, Evidence::Ptr evidence)
         auto indexIt = state_.evidenceToWME_.find(evidence);
         if (indexIt != state_.evidenceToWME_.end())
         {
-            auto vIt = std::remove_if(indexIt->second.begin(), indexIt->second.end(),
-                                        [wme](WME::Ptr w) -> bool
-                                        {
-                                            return *w == *wme;
-                                        }
-                                    );
-            indexIt->second.erase(vIt, indexIt->second.end());
+            indexIt->second.remove(it->getId());
         }
 
         // now, can we already remove the WME?
@@ -250,7 +417,7 @@ void Reasoner::removeEvidence(WME::Ptr wme, Evidence::Ptr evidence)
             state_.backedWMEs_.erase(it);
         } else {
             // the WME seems to be still backed -- but really? check and clean up loops!
-            cleanupInferenceLoops(wme);
+            stillBacked.push_back(it->getWME());
         }
     }
     else
@@ -260,84 +427,206 @@ void Reasoner::removeEvidence(WME::Ptr wme, Evidence::Ptr evidence)
 }
 
 
-
-void Reasoner::cleanupInferenceLoops(WME::Ptr entryPoint)
+void Reasoner::indexDependencies(const Evidence::Ptr& evidence)
 {
-    /*
-        The reason this method was called is that an evidence for entryPoint has been removed.
-        now we need to check if the remaining evidences for it are still grounded in asserted
-        evidences, or form an inference-loop.
-        If it forms a loop we need to completely remove the WME, and all the evidences it resides
-        in, recursivly triggering 'cleanupInferenceLoops' again.
-    */
-    std::set<WME::Ptr> notHolding;
-    bool holds = checkIfFactHolds(entryPoint, notHolding);
-    if (!holds)
+    auto inferred = std::dynamic_pointer_cast<InferredEvidence>(evidence);
+    if (!inferred) return;
+
+    for (auto token = inferred->token(); token; token = token->parent)
     {
-        std::cout << "FOUND A CIRCLE! These WMEs do not hold anymore:" << std::endl;
-        for (auto wme : notHolding)
+        // The alpha memories only let the first instance of equal WMEs pass into the tokens,
+        // which is the one that is stored as the backed WME.
+        if (token->wme && state_.backedWMEs_.find(token->wme) != state_.backedWMEs_.end())
         {
-            std::cout << "  " << wme->toString() << std::endl;
-            remove(wme);
+            state_.dependents_[token->wme.get()].insert(evidence);
         }
-
     }
 }
 
+void Reasoner::unindexDependencies(const Evidence::Ptr& evidence)
+{
+    auto inferred = std::dynamic_pointer_cast<InferredEvidence>(evidence);
+    if (!inferred) return;
+
+    for (auto token = inferred->token(); token; token = token->parent)
+    {
+        if (!token->wme) continue;
 
-bool Reasoner::checkIfEvidenceHolds(Evidence::Ptr evidence, std::set<WME::Ptr>& notHolding)
+        auto it = state_.dependents_.find(token->wme.get());
+        if (it == state_.dependents_.end()) continue;
+
+        it->second.erase(evidence);
+        if (it->second.empty()) state_.dependents_.erase(it);
+    }
+}
+
+size_t Reasoner::evidenceRank(const Evidence::Ptr& evidence,
+                              const std::unordered_set<const WME*>& excluded) const
 {
-    auto asserted = std::dynamic_pointer_cast<AssertedEvidence>(evidence);
-    if (asserted) return true;
+    if (std::dynamic_pointer_cast<AssertedEvidence>(evidence)) return 0;
 
     auto inferred = std::dynamic_pointer_cast<InferredEvidence>(evidence);
-    if (inferred)
+    if (!inferred) return noRank; // neither asserted nor inferred?!
+
+    size_t rank = 1;
+    for (auto token = inferred->token(); token; token = token->parent)
     {
-        Token::Ptr token = inferred->token();
-        while (token)
+        // no need to check computations of builtins
+        if (!token->wme || token->wme->isComputed()) continue;
+
+        auto backed = state_.backedWMEs_.find(token->wme);
+        if (backed == state_.backedWMEs_.end())
         {
-            if (!checkIfFactHolds(token->wme, notHolding))
-            {
-                return false;
-            }
-            token = token->parent;
+            // A fact that was removed, but whose retraction has not yet been processed on the
+            // agenda, is still known as a dependency. Everything else that is not backed is
+            // created inside the network, e.g. by noValue or GROUP BY, and is fine.
+            if (state_.dependents_.find(token->wme.get()) != state_.dependents_.end())
+                return noRank;
+            continue;
         }
-        // all wme in token hold? --> evidence holds.
-        return true;
+
+        if (excluded.find(backed->getWME().get()) != excluded.end()) return noRank;
+        if (backed->getRank() == noRank) return noRank;
+        rank = std::max(rank, backed->getRank() + 1);
     }
+    return rank;
+}
 
-    // neither asserted nor inferred?!
-    return false;
+size_t Reasoner::factRank(const BackedWME& fact,
+                          const std::unordered_set<const WME*>& excluded) const
+{
+    size_t rank = noRank;
+    for (auto& evidence : fact)
+    {
+        rank = std::min(rank, evidenceRank(evidence, excluded));
+    }
+    return rank;
 }
 
-bool Reasoner::checkIfFactHolds(WME::Ptr fact, std::set<WME::Ptr>& notHolding)
+template <class F>
+void Reasoner::forEachDependent(const WME* fact, F&& f) const
 {
-    // no need to check computations of builtins
-    if (fact->isComputed()) return true;
+    auto dependents = state_.dependents_.find(fact);
+    if (dependents == state_.dependents_.end()) return;
+
+    for (auto& evidence : dependents->second)
+    {
+        auto wmes = state_.evidenceToWME_.find(evidence);
+        if (wmes == state_.evidenceToWME_.end()) continue;
+
+        for (auto& wme : wmes->second.wmes())
+        {
+            auto backed = state_.backedWMEs_.find(wme);
+            if (backed != state_.backedWMEs_.end()) f(*backed);
+        }
+    }
+}
 
-    // no need to check if we already know it does not hold
-    if (notHolding.find(fact) != notHolding.end()) return false;
+void Reasoner::cleanupInferenceLoops(const std::vector<WME::Ptr>& entryPoints)
+{
+    /*
+        The reason this method was called is that evidences for the entryPoints have been
+        removed. Now we need to check if the remaining evidences are still grounded in asserted
+        evidences, or form inference-loops.
+
+        First, find the affected facts: A fact is fine as long as it has an evidence whose token
+        only contains facts of lower rank that are not affected themselves. Only facts of a higher
+        rank can depend on an affected fact that way, so visiting the facts in the order of their
+        ranks makes sure that all affected facts a fact might depend on are known before the fact
+        is checked.
+    */
+    typedef std::pair<size_t, const BackedWME*> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
 
-    // assume it does not hold:
-    notHolding.insert(fact);
+    for (auto& wme : entryPoints)
+    {
+        auto backed = state_.backedWMEs_.find(wme);
+        if (backed != state_.backedWMEs_.end()) queue.push({backed->getRank(), &*backed});
+    }
 
-    // check if it even exists
-    auto backed = state_.backedWMEs_.find(fact);
-    if (backed == state_.backedWMEs_.end()) return false;
+    std::unordered_set<const WME*> checked;
+    std::unordered_set<const WME*> affected;
+    std::vector<const BackedWME*> affectedFacts;
 
-    // check every evidence
-    for (auto evidence : *backed)
+    while (!queue.empty())
     {
-        if (checkIfEvidenceHolds(evidence, notHolding))
+        const BackedWME* fact = queue.top().second;
+        queue.pop();
+        if (!checked.insert(fact->getWME().get()).second) continue;
+
+        bool justified = false;
+        for (auto& evidence : *fact)
         {
-            // only need one evidence to hold!
-            notHolding.erase(fact);
-            return true;
+            if (evidenceRank(evidence, affected) <= fact->getRank())
+            {
+                justified = true;
+                break;
+            }
         }
+        if (justified) continue;
+
+        affected.insert(fact->getWME().get());
+        affectedFacts.push_back(fact);
+
+        forEachDependent(fact->getWME().get(),
+            [&](const BackedWME& dependent)
+            {
+                if (dependent.getRank() > fact->getRank())
+                    queue.push({dependent.getRank(), &dependent});
+            });
+    }
+
+    if (affectedFacts.empty()) return;
+
+    /*
+        Some of the affected facts may still be derived from facts that are not affected, just
+        with a longer derivation. Find those and their new ranks, again in the order of the ranks,
+        starting with the lowest: When a fact is taken from the queue, no other evidence for it
+        can lead to a lower rank anymore.
+    */
+    std::unordered_set<const WME*> unresolved = affected;
+    for (auto fact : affectedFacts)
+    {
+        size_t rank = factRank(*fact, unresolved);
+        if (rank != noRank) queue.push({rank, fact});
     }
 
-    // none of the evidence held, so the fact does not either.
-    return false;
+    while (!queue.empty())
+    {
+        size_t rank = queue.top().first;
+        const BackedWME* fact = queue.top().second;
+        queue.pop();
+        if (!unresolved.erase(fact->getWME().get())) continue;
+
+        fact->setRank(rank);
+
+        forEachDependent(fact->getWME().get(),
+            [&](const BackedWME& dependent)
+            {
+                if (unresolved.find(dependent.getWME().get()) == unresolved.end()) return;
+
+                size_t rank = factRank(dependent, unresolved);
+                if (rank != noRank) queue.push({rank, &dependent});
+            });
+    }
+
+    // everything that is still unresolved is only held by loops
+    std::vector<WME::Ptr> notHolding;
+    for (auto fact : affectedFacts)
+    {
+        if (unresolved.find(fact->getWME().get()) != unresolved.end())
+            notHolding.push_back(fact->getWME());
+    }
+
+    if (!notHolding.empty())
+    {
+        std::cout << "FOUND A CIRCLE! These WMEs do not hold anymore:" << std::endl;
+        for (auto wme : notHolding)
+        {
+            std::cout << "  " << wme->toString() << std::endl;
+            remove(wme);
+        }
+    }
 }
 
 
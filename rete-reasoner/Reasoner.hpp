@@ -4,6 +4,8 @@
 #include <map>
 #include <set>
 #include <functional>
+#include <memory>
+#include <unordered_set>
 
 #include "../rete-core/Network.hpp"
 #include "BackedWME.hpp"
@@ -35,8 +37,22 @@ class Reasoner {
     std::vector<AgendaItem> history_;
     size_t maxHistorySize_;
 
+    /**
+        Number of threads to use where the work can be split, see setNumThreads.
+    */
+    size_t numThreads_;
+
+    /**
+        The last published snapshot. Only accessed through std::atomic_load/atomic_store.
+    */
+    std::shared_ptr<const InferenceState> snapshot_;
+
 public:
-    Reasoner(size_t historySize = 10) : maxHistorySize_(historySize) {}
+    Reasoner(size_t historySize = 10)
+        : maxHistorySize_(historySize), numThreads_(1),
+          snapshot_(std::make_shared<InferenceState>())
+    {
+    }
 
     /**
         returns a reference to the internal rete network
@@ -57,6 +73,30 @@ public:
     */
     InferenceState getCurrentState() const;
 
+    /**
+        Publishes a snapshot of the current inference state, which can be read through
+        getSnapshot() from other threads while the reasoner goes on. Usually called after
+        performInference, to publish a consistent state. Creating the snapshot copies the state
+        and the tokens of its inferred evidences (see InferenceState::freeze()), so this is
+        more expensive than getCurrentState() -- but the copy is made only once per published
+        state, no matter how many readers there are, and readers never wait for it.
+    */
+    void publishSnapshot();
+
+    /**
+        Returns the last snapshot published through publishSnapshot(), or an empty state if none
+        was published yet. This is the only method that may be called concurrently with the
+        others: It does not copy anything, and the returned snapshot is immutable, so it can be
+        read without any locking while the reasoner modifies its current state -- the WMEs, the
+        evidences and explanations, including the tokens and token groups of inferred
+        evidences. The WMEs are shared with the network, which is fine as long as they are
+        immutable -- like the results of builtins, which copy everything their descriptions
+        need. The only exception are WMEs that you change in place yourself and announce
+        through an UPDATE.
+        Every snapshot stays valid as long as it is referenced.
+    */
+    std::shared_ptr<const InferenceState> getSnapshot() const;
+
     /**
         As long as the Agenda is not empty, takes the first AgendaItem and processes it, adding and
         removing evidence in the process, updating the Agenda. May cause infinite loops if the
@@ -78,6 +118,14 @@ public:
     */
     void addEvidence(WME::Ptr wme, Evidence::Ptr evidence);
 
+    /**
+        Adds a whole batch of evidences for WMEs at once. The result is the same as calling
+        addEvidence for every entry, but the new WMEs are processed through the Rete network
+        together, node by node instead of WME by WME, which avoids a lot of overhead when adding
+        large amounts of data. Does *not* automatically infer knowledge.
+    */
+    void addEvidence(const std::vector<std::pair<WME::Ptr, Evidence::Ptr>>& evidences);
+
     /**
         Removes the evidence for the WME. If there are no more evidences for it, the WME is
         retracted from the Rete network, and more inferred WMEs that relied on the WME are removed,
@@ -102,7 +150,49 @@ public:
     */
     void setCallback(std::function<void(WME::Ptr, rete::PropagationFlag)>);
 
+    /**
+        Sets the number of threads the reasoner may use. They are used to check large batches of
+        evidences (see addEvidence(const std::vector<...>&)) in the alpha network concurrently,
+        and to execute the productions of the ASSERTs at the front of the agenda concurrently in
+        performInference (see Production::isConcurrent()). The results are the same for any
+        number of threads.
+        Default is 1, i.e., everything is done on the calling thread.
+    */
+    void setNumThreads(size_t threads);
+
+    /**
+        Returns the approximate number of bytes used by the reasoner: The network with its
+        agenda (see Network::getMemoryUsage()), the inference state, and the history. Published
+        snapshots are not included.
+        To find out which rules use the most memory, let a MemoryUsageVisitor visit them
+        through ParsedRule::accept.
+    */
+    size_t getMemoryUsage() const;
+
 private:
+    /**
+        Adds the evidence for the WME to the state and calls the callback if the WME is new.
+        Does not announce the WME to the Rete network. Returns true if the WME is new, i.e. if it
+        needs to be announced.
+    */
+    bool backWME(WME::Ptr wme, Evidence::Ptr evidence);
+
+    void addToHistory(const AgendaItem&);
+
+    /**
+        Processes the WMEs the production of the agenda item inferred: Adds or removes the
+        evidences for them, depending on the flag of the item.
+    */
+    void processInferred(const AgendaItem&, std::vector<WME::Ptr>& inferred);
+
+    /**
+        Executes the productions of up to maxSteps ASSERTs at the front of the agenda
+        concurrently, and processes their results in the order of the agenda -- but only as long
+        as the items are still the next ones on the agenda, so that the result is exactly the
+        same as when processing them one by one. Returns the number of processed items, which is
+        0 if there were not enough items to execute them concurrently.
+    */
+    size_t performConcurrentInferenceSteps(size_t maxSteps);
 
     /**
         Loops in the inference chain can lead to the case where a fact is inferred through itself,
@@ -117,18 +207,19 @@ private:
         (<B> <equiv> <A>) <- [(<A> <equiv> <B>)]
 
         If we now remove the assertion, both facts still have evidence, but are ultimately in a
-        loop without any asserted base fact. To clean this up, the cleanupInferenceLoops does the
-        following: The entryPoint is the fact which no longer has any AssertedEvidence. We assume
-        that it is no longer valid and go on to check if any InferredEvidence for T would still
-        hold. If yes than there are other sources which are backed by asserted facts and everything
-        is fine -- if not there are loops which need to be collapsed.
+        loop without any asserted base fact. To detect this, every backed WME has a rank (see
+        BackedWME::getRank()): A WME holds if one of its evidences only depends on WMEs of a lower
+        rank, which hold themselves. Asserted evidences always hold.
 
-        An InferredEvidence holds if all WMEs in its token still hold; a WME still holds if it has
-        either an AssertedEvidence or any of its InferredEvidences still hold (assuming that T does
-        *not* hold). All WMEs that do not hold under the assumption that T does not hold are kept
-        in a list, and if in the end none of Ts evidences hold anymore, all of those are removed.
+        The entryPoints are the WMEs that lost an evidence but still have others. Starting at
+        them, the WMEs that lost their justification are collected in the order of their ranks,
+        following only the evidences that depend on them. Afterwards, those that can still be
+        derived from WMEs that are not affected get new ranks, and all others are removed, as
+        they are only held by loops.
+        Both steps only visit the region of the inference graph that is actually affected by the
+        removal, and work without any recursion.
 
-        This scan must always be done when removing an evidence, be it an Asserted- or InferredEvidence. E.g.:
+        This must always be done when removing an evidence, be it an Asserted- or InferredEvidence. E.g.:
 
         [A] -> [B] -> [C]
                 ^------'
@@ -138,36 +229,33 @@ private:
         namely [C]->[B], -- a circle that could not be found because A does not have a pointer to
         B, only B has one to A. So the check must be done when removing inferred evidences, too.
     */
-    void cleanupInferenceLoops(WME::Ptr entryPoint);
+    void cleanupInferenceLoops(const std::vector<WME::Ptr>& entryPoints);
 
     /**
-        This method checks if a fact still holds or is only there due to circles in the inference
-        chain but not backed by asserted evidence anymore.
-
-        It adds the fact to the notHolding set (assumes it does not hold) and then proceeds to
-        check if an evidence for it exists that still holds under this assumption. An evidence for
-        A that only holds if A holds is the result of a chain, while those who still hold signal
-        that if A would be removed it could still be reconstructed through some rule and this
-        evidence.
-
-        - AssertedEvidence always holds.
-        - InferredEvidence only holds if all WMEs needed for it still hold -- this is where this
-          method recurses to check for connected circles.
+        Removes the evidence from the WME. If the WME is not backed anymore it is retracted,
+        else it is added to stillBacked, to be checked by cleanupInferenceLoops.
+    */
+    void detachEvidence(WME::Ptr wme, Evidence::Ptr evidence, std::vector<WME::Ptr>& stillBacked);
 
-        If in the end there is still a valid evidence for the fact, the fact is removed from the
-        notHolding set again and 'true' is returned
-        If the fact does not hold it stays in the set (so that future checks in different areas of
-        the graph don't need to redo this part), and 'false' is returned.
+    /**
+        Adds the evidence to / removes it from the dependents_ of the backed WMEs in its token.
+    */
+    void indexDependencies(const Evidence::Ptr& evidence);
+    void unindexDependencies(const Evidence::Ptr& evidence);
 
-        When the method returns 'false' it does *not* mean that 'notHolding' contains all circles
-        involved! It only contains the nodes that are found to not hold so far, but the check
-        aborts as soon as a single evidence is found that definitely holds.
+    /**
+        The rank the evidence gives to the WMEs it backs, or std::numeric_limits<size_t>::max()
+        if it does not hold -- e.g. because it depends on one of the excluded WMEs.
     */
-    bool checkIfFactHolds(WME::Ptr fact, std::set<WME::Ptr>& notHolding);
+    size_t evidenceRank(const Evidence::Ptr& evidence,
+                        const std::unordered_set<const WME*>& excluded) const;
 
-    /** Helper for checkIfFactHolds */
-    bool checkIfEvidenceHolds(Evidence::Ptr evidence, std::set<WME::Ptr>& notHolding);
+    /** The lowest rank any of the evidences of the fact gives it */
+    size_t factRank(const BackedWME& fact, const std::unordered_set<const WME*>& excluded) const;
 
+    /** Calls f for every backed WME that has an evidence depending on the fact */
+    template <class F>
+    void forEachDependent(const WME* fact, F&& f) const;
 
     /**
         Forcely removes a WME from the reasoner, despite any evidences that are still left.
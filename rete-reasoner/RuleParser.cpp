@@ -59,6 +59,9 @@ RuleParser::RuleParser()
 
     registerNodeBuilder<builtin::MathBulkBuiltinBuilder<builtin::SumBulk>>("SumBulk");
     registerNodeBuilder<builtin::MathBulkBuiltinBuilder<builtin::MulBulk>>("MulBulk");
+    registerNodeBuilder<builtin::MathBulkBuiltinBuilder<builtin::MinBulk>>("MinBulk");
+    registerNodeBuilder<builtin::MathBulkBuiltinBuilder<builtin::MaxBulk>>("MaxBulk");
+    registerNodeBuilder<builtin::MathBulkBuiltinBuilder<builtin::AvgBulk>>("AvgBulk");
     registerNodeBuilder<builtin::CountEntriesInGroupBuilder>();
     registerNodeBuilder<builtin::CompareNodeBuilder<builtin::Compare::LT>>();
     registerNodeBuilder<builtin::CompareNodeBuilder<builtin::Compare::LE>>();
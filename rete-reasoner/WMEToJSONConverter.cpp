@@ -13,7 +13,7 @@ bool TripleToJSONConverter::convert(WME::Ptr wme, std::string& json)
 
     nlohmann::json j;
     j["type"] = "triple";
-    j["description"] = triple->description_;
+    j["description"] = triple->getDescription();
     j["value"]["subject"] = triple->getField(Triple::SUBJECT);
     j["value"]["predicate"] = triple->getField(Triple::PREDICATE);
     j["value"]["object"] = triple->getField(Triple::OBJECT);
@@ -28,7 +28,7 @@ bool DefaultToJSONConverter::convert(WME::Ptr wme, std::string& json)
     nlohmann::json j;
     j["type"] = "unknown";
     j["value"] = wme->toString();
-    j["description"] = wme->description_;
+    j["description"] = wme->getDescription();
 
     json = j.dump();
     return true;
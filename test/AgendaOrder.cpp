@@ -0,0 +1,68 @@
+#include <iostream>
+
+#include "../rete-core/ReteCore.hpp"
+
+using namespace rete;
+
+class Noop : public Production {
+public:
+    Noop(int priority) : Production(priority, "noop") {}
+    void execute(Token::Ptr, PropagationFlag, std::vector<WME::Ptr>&) override {}
+};
+
+/**
+    The agenda processes items by priority, then RETRACT before UPDATE before
+    ASSERT, and in the order they were added otherwise. An ASSERT followed by a
+    RETRACT of the same match cancels both, and an UPDATE of a match that is
+    still to be ASSERTed is dropped.
+*/
+int main()
+{
+    Agenda agenda;
+    auto name = std::make_shared<const std::string>("rule");
+    Production::Ptr low(new Noop(0));
+    Production::Ptr high(new Noop(10));
+
+    std::vector<Token::Ptr> tokens;
+    for (int i = 0; i < 6; i++) tokens.push_back(std::make_shared<Token>());
+
+    agenda.add(tokens[0], low, rete::ASSERT, name);
+    agenda.add(tokens[1], low, rete::ASSERT, name);
+    agenda.add(tokens[2], low, rete::RETRACT, name);
+    agenda.add(tokens[3], high, rete::ASSERT, name);
+    agenda.add(tokens[4], low, rete::UPDATE, name);
+
+    // cancelled
+    agenda.add(tokens[5], low, rete::ASSERT, name);
+    agenda.add(tokens[5], low, rete::RETRACT, name);
+
+    // ignored, as the ASSERT is still pending
+    agenda.add(tokens[0], low, rete::UPDATE, name);
+
+    // the same token in a different production is a different item
+    agenda.add(tokens[0], high, rete::RETRACT, name);
+
+    std::vector<std::pair<Token::Ptr, Production::Ptr>> expected = {
+        {tokens[0], high}, {tokens[3], high},
+        {tokens[2], low}, {tokens[4], low}, {tokens[0], low}, {tokens[1], low}
+    };
+
+    for (auto& e : expected)
+    {
+        if (agenda.empty()) return 1;
+        auto item = agenda.front();
+        if (std::get<0>(item) != e.first || std::get<1>(item) != e.second) return 2;
+        if (std::get<3>(item) != "rule") return 3;
+        agenda.pop_front();
+    }
+
+    if (!agenda.empty()) return 4;
+
+    // remove requires the flag to match
+    agenda.add(tokens[1], low, rete::ASSERT, name);
+    if (agenda.remove(AgendaItem{tokens[1], low, rete::RETRACT, "rule"})) return 5;
+    if (!agenda.remove(AgendaItem{tokens[1], low, rete::ASSERT, "rule"})) return 6;
+    if (!agenda.empty()) return 7;
+
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <iostream>
+
+#include "../rete-core/ReteCore.hpp"
+#include "../rete-rdf/ReteRDF.hpp"
+
+using namespace rete;
+
+/**
+    AlphaNodes that check the same field of a triple for a constant are
+    activated through a dispatch index by their parent. Make sure every
+    memory still gets exactly the matching WMEs, also when nodes are added
+    after the WMEs, and that retractions reach them.
+*/
+int main()
+{
+    Network net;
+    auto root = net.getRoot();
+    TripleTypeAlpha::Ptr typeCheck(new TripleTypeAlpha()); SetParent(root, typeCheck);
+
+    std::vector<TripleAlpha::Ptr> nodes;
+    std::vector<AlphaMemory::Ptr> mems;
+    auto addCheck = [&](Triple::Field field, const std::string& value)
+    {
+        TripleAlpha::Ptr node(new TripleAlpha(field, value));
+        SetParent(typeCheck, node);
+        auto mem = std::make_shared<AlphaMemory>();
+        SetParent(node, mem);
+        nodes.push_back(node);
+        mems.push_back(mem);
+    };
+
+    for (int i = 0; i < 5; i++) addCheck(Triple::PREDICATE, "<p" + std::to_string(i) + ">");
+    addCheck(Triple::SUBJECT, "<s0>");
+    addCheck(Triple::SUBJECT, "<s1>");
+    addCheck(Triple::PREDICATE, "<p0>"); // a second one for <p0>
+
+    for (int s = 0; s < 3; s++)
+    {
+        for (int p = 0; p < 6; p++)
+        {
+            root->activate(
+                std::make_shared<Triple>("<s" + std::to_string(s) + ">",
+                                         "<p" + std::to_string(p) + ">", "<o>"),
+                rete::ASSERT);
+        }
+    }
+
+    // 3 subjects per predicate, 6 predicates per subject
+    for (int i = 0; i < 5; i++) if (mems[i]->size() != 3) return 1;
+    if (mems[5]->size() != 6 || mems[6]->size() != 6) return 2;
+    if (mems[7]->size() != 3) return 3;
+
+    // added later, must be initialized with the existing WMEs
+    addCheck(Triple::PREDICATE, "<p5>");
+    addCheck(Triple::OBJECT, "<o>");
+    if (mems[8]->size() != 3) return 4;
+    if (mems[9]->size() != 18) return 5;
+    // ... without duplicating anything in the other memories
+    for (int i = 0; i < 5; i++) if (mems[i]->size() != 3) return 6;
+
+    root->activate(std::make_shared<Triple>("<s0>", "<p0>", "<o>"), rete::RETRACT);
+    if (mems[0]->size() != 2 || mems[7]->size() != 2) return 7;
+    if (mems[5]->size() != 5 || mems[9]->size() != 17) return 8;
+    if (mems[1]->size() != 3 || mems[6]->size() != 6) return 9;
+
+    // UPDATEs are dispatched, too
+    root->activate(std::make_shared<Triple>("<s1>", "<p1>", "<o>"), rete::UPDATE);
+    if (mems[1]->size() != 3 || mems[6]->size() != 6) return 10;
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <algorithm>
+#include "../rete-reasoner/RuleParser.hpp"
+#include "../rete-reasoner/Reasoner.hpp"
+#include "../rete-reasoner/AssertedEvidence.hpp"
+#include "../rete-rdf/ReteRDF.hpp"
+
+using namespace rete;
+
+const std::string rules =
+    "[trans: (?a <p> ?b), (?b <p> ?c) -> (?a <p> ?c)]"
+    "[sym: (?a <q> ?b), (?b <q> ?a), (?a <type> <T>) -> (?a <mutual> ?b)]"
+    "[lonely: (?a <type> <T>), noValue { (?a <q> ?x) } -> (?a <lonely> \"yes\")]"
+    "[less: (?a <num> ?n), (?b <num> ?m), lt(?n ?m) -> (?a <less> ?b)]"
+    "[grp: (?a <q> ?b), GROUP BY (?a), count(?c ?b) -> (?a <qcount> ?c)]";
+
+std::vector<std::string> sortedState(Reasoner& reasoner)
+{
+    std::vector<std::string> result;
+    for (auto wme : reasoner.getCurrentState().getWMEs())
+    {
+        result.push_back(wme->toString());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+/**
+    Adding a batch of evidences must lead to the same results as adding them one by one -- also
+    when parts of the batch were already known, and when the batch contains duplicates.
+*/
+int main()
+{
+    RuleParser parser;
+    Reasoner single, batched;
+    auto singleRules = parser.parseRules(rules, single.net());
+    auto batchedRules = parser.parseRules(rules, batched.net());
+
+    auto ev1 = std::make_shared<AssertedEvidence>("ev1");
+    auto ev2 = std::make_shared<AssertedEvidence>("ev2");
+
+    std::vector<std::pair<WME::Ptr, Evidence::Ptr>> first, second;
+    for (int i = 0; i < 8; i++)
+    {
+        std::string a = "<n" + std::to_string(i) + ">";
+        std::string b = "<n" + std::to_string((i + 1) % 8) + ">";
+        std::string c = "<n" + std::to_string((i * 3) % 8) + ">";
+
+        first.push_back({std::make_shared<Triple>(a, "<p>", b), ev1});
+        first.push_back({std::make_shared<Triple>(a, "<num>", std::to_string(i % 3)), ev1});
+        if (i % 2) first.push_back({std::make_shared<Triple>(a, "<type>", "<T>"), ev1});
+
+        second.push_back({std::make_shared<Triple>(a, "<q>", c), ev2});
+        second.push_back({std::make_shared<Triple>(c, "<q>", a), ev2});
+        second.push_back({std::make_shared<Triple>(a, "<type>", "<T>"), ev2});
+    }
+
+    for (auto& entry : first) single.addEvidence(entry.first, entry.second);
+    batched.addEvidence(first);
+
+    single.performInference();
+    batched.performInference();
+    if (sortedState(single) != sortedState(batched)) return 1;
+
+    // partly known, with duplicates, on top of inferred data
+    for (auto& entry : second) single.addEvidence(entry.first, entry.second);
+    batched.addEvidence(second);
+
+    single.performInference();
+    batched.performInference();
+
+    auto result = sortedState(batched);
+    if (sortedState(single) != result) return 2;
+
+    std::cout << result.size() << " WMEs" << std::endl;
+
+    // removing the evidences again must work as usual
+    batched.removeEvidence(ev2);
+    batched.performInference();
+    single.removeEvidence(ev2);
+    single.performInference();
+    if (sortedState(single) != sortedState(batched)) return 3;
+
+    batched.removeEvidence(ev1);
+    batched.performInference();
+    if (!sortedState(batched).empty()) return 4;
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include <iostream>
+#include "../rete-reasoner/RuleParser.hpp"
+#include "../rete-reasoner/Reasoner.hpp"
+#include "../rete-reasoner/AssertedEvidence.hpp"
+#include "../rete-rdf/ReteRDF.hpp"
+
+using namespace rete;
+
+/**
+    A single evidence that backs lots of WMEs, which are removed one by one. The index from the
+    evidence to its WMEs must stay consistent, and every removal must not depend on the number of
+    WMEs the evidence supports.
+*/
+int main()
+{
+    RuleParser parser;
+    Reasoner reasoner;
+    auto rules = parser.parseRules(
+        "[copy: (?a <p> ?b) -> (?b <q> ?a)]",
+        reasoner.net());
+
+    const int n = 50000;
+    auto ev = std::make_shared<AssertedEvidence>("source");
+    std::vector<WME::Ptr> wmes;
+    for (int i = 0; i < n; i++)
+    {
+        wmes.push_back(std::make_shared<Triple>("<n" + std::to_string(i) + ">", "<p>", "<x>"));
+        reasoner.addEvidence(wmes.back(), ev);
+    }
+
+    // adding the same evidence again, even with a different but equal WME, changes nothing
+    reasoner.addEvidence(std::make_shared<Triple>("<n0>", "<p>", "<x>"), ev);
+    reasoner.performInference();
+
+    auto state = reasoner.getCurrentState();
+    if (state.numWMEs() != 2 * n) return 1;
+    if (state.explainedBy(std::make_shared<AssertedEvidence>("source")).wmes_.size() != n) return 2;
+    if (state.explain(wmes[0]).evidences_.size() != 1) return 3;
+
+    // remove every other WME
+    for (int i = 0; i < n; i += 2)
+    {
+        reasoner.removeEvidence(wmes[i], ev);
+    }
+    reasoner.performInference();
+
+    state = reasoner.getCurrentState();
+    if (state.numWMEs() != n) return 4;
+
+    auto left = state.explainedBy(ev).wmes_;
+    if (left.size() != n / 2) return 5;
+    for (auto wme : left)
+    {
+        auto triple = std::static_pointer_cast<Triple>(wme);
+        int i = std::stoi(triple->subject.substr(2));
+        if (i % 2 == 0) return 6;
+    }
+
+    std::cout << state.numWMEs() << " WMEs left" << std::endl;
+
+    // and the rest, all at once
+    reasoner.removeEvidence(ev);
+    reasoner.performInference();
+    if (reasoner.getCurrentState().numWMEs() != 0) return 7;
+    if (reasoner.getCurrentState().numEvidences() != 0) return 8;
+
+    return 0;
+}
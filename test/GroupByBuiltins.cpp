@@ -1,5 +1,6 @@
 #include <iostream>
 #include <fstream>
+#include <limits>
 
 #include "../rete-reasoner/Reasoner.hpp"
 #include "../rete-reasoner/RuleParser.hpp"
@@ -255,6 +256,210 @@ bool count_and_compare()
 
 }
 
+bool min_max_avg()
+{
+    RuleParser p;
+    Reasoner reasoner;
+    auto rules = p.parseRules(
+        "[(?player <scored> ?points),"
+        " GROUP BY (?player),"
+        " MinBulk(?min ?points), MaxBulk(?max ?points), AvgBulk(?avg ?points)"
+        " -> (?player <min> ?min), (?player <max> ?max), (?player <avg> ?avg)]",
+        reasoner.net()
+    );
+
+    auto ev = std::make_shared<AssertedEvidence>("asserted");
+    auto addScore = [&](int score) -> Triple::Ptr
+    {
+        auto triple = std::make_shared<Triple>("<p1>", "<scored>", std::to_string(score));
+        reasoner.addEvidence(triple, ev);
+        return triple;
+    };
+
+    addScore(4);
+    auto t1 = addScore(1);
+    auto t10 = addScore(10);
+    addScore(5);
+
+    reasoner.performInference();
+    if (!containsTriple(reasoner, "<p1>", "<min>", std::to_string(1.f)) ||
+        !containsTriple(reasoner, "<p1>", "<max>", std::to_string(10.f)) ||
+        !containsTriple(reasoner, "<p1>", "<avg>", std::to_string(5.f)))
+        return false;
+
+    reasoner.removeEvidence(t1, ev);
+    reasoner.removeEvidence(t10, ev);
+    reasoner.performInference();
+
+    return containsTriple(reasoner, "<p1>", "<min>", std::to_string(4.f)) &&
+           containsTriple(reasoner, "<p1>", "<max>", std::to_string(5.f)) &&
+           containsTriple(reasoner, "<p1>", "<avg>", std::to_string(4.5f));
+}
+
+
+bool mul_bulk_zero()
+{
+    RuleParser p;
+    Reasoner reasoner;
+    auto rules = p.parseRules(
+        "[(?s <factor> ?f), GROUP BY (?s), MulBulk(?p ?f) -> (?s <product> ?p)]",
+        reasoner.net()
+    );
+
+    auto ev = std::make_shared<AssertedEvidence>("asserted");
+    auto two = std::make_shared<Triple>("<s1>", "<factor>", "2");
+    auto zero = std::make_shared<Triple>("<s1>", "<factor>", "0");
+    auto three = std::make_shared<Triple>("<s1>", "<factor>", "3");
+    reasoner.addEvidence(two, ev);
+    reasoner.addEvidence(zero, ev);
+    reasoner.addEvidence(three, ev);
+    reasoner.performInference();
+
+    if (!containsTriple(reasoner, "<s1>", "<product>", std::to_string(0.f)))
+        return false;
+
+    reasoner.removeEvidence(zero, ev);
+    reasoner.performInference();
+
+    return containsTriple(reasoner, "<s1>", "<product>", std::to_string(6.f));
+}
+
+/**
+    Adding and removing values of very different magnitudes must not leave rounding errors in
+    the aggregates, independent of the order in which it happens.
+*/
+bool bulk_magnitudes()
+{
+    RuleParser p;
+    Reasoner reasoner;
+    auto rules = p.parseRules(
+        "[(?s <value> ?v), GROUP BY (?s),"
+        " SumBulk(?sum ?v), AvgBulk(?avg ?v), MulBulk(?mul ?v)"
+        " -> (?s <sum> ?sum), (?s <avg> ?avg), (?s <mul> ?mul)]",
+        reasoner.net()
+    );
+
+    auto ev = std::make_shared<AssertedEvidence>("asserted");
+    auto huge = std::make_shared<Triple>("<s1>", "<value>", "1e30");
+    auto large = std::make_shared<Triple>("<s1>", "<value>", "16777216");
+    auto two = std::make_shared<Triple>("<s1>", "<value>", "2");
+    auto one = std::make_shared<Triple>("<s1>", "<value>", "1");
+
+    // 2^24 + 1 is not representable as a float
+    reasoner.addEvidence(large, ev);
+    reasoner.addEvidence(one, ev);
+    reasoner.performInference();
+    reasoner.removeEvidence(large, ev);
+    reasoner.performInference();
+
+    if (!containsTriple(reasoner, "<s1>", "<sum>", std::to_string(1.f)) ||
+        !containsTriple(reasoner, "<s1>", "<avg>", std::to_string(1.f)) ||
+        !containsTriple(reasoner, "<s1>", "<mul>", std::to_string(1.f)))
+        return false;
+
+    // 1e30 * 1e30 overflows to inf, the sum loses the small values
+    reasoner.addEvidence(huge, ev);
+    reasoner.addEvidence(std::make_shared<Triple>("<s1>", "<value>", "1.0e30"), ev);
+    reasoner.addEvidence(two, ev);
+    reasoner.performInference();
+    if (!containsTriple(reasoner, "<s1>", "<mul>",
+                        std::to_string(std::numeric_limits<float>::infinity())))
+        return false;
+
+    reasoner.removeEvidence(huge, ev);
+    reasoner.performInference();
+    if (!containsTriple(reasoner, "<s1>", "<mul>", std::to_string(2e30f)))
+        return false;
+
+    reasoner.removeEvidence(std::make_shared<Triple>("<s1>", "<value>", "1.0e30"), ev);
+    reasoner.performInference();
+
+    return containsTriple(reasoner, "<s1>", "<sum>", std::to_string(3.f)) &&
+           containsTriple(reasoner, "<s1>", "<avg>", std::to_string(1.5f)) &&
+           containsTriple(reasoner, "<s1>", "<mul>", std::to_string(2.f)) &&
+           reasoner.getCurrentState().numWMEs() == 5;
+}
+
+/**
+    Returns the WMEs in the tokens of the evidences of the given WME that have a description,
+    i.e., the results of builtins.
+*/
+std::vector<WME::Ptr> describedWMEs(Reasoner& reasoner, WME::Ptr wme)
+{
+    std::vector<WME::Ptr> described;
+    for (auto evidence : reasoner.getCurrentState().explain(wme).evidences_)
+    {
+        auto inferred = std::dynamic_pointer_cast<InferredEvidence>(evidence);
+        if (!inferred) continue;
+
+        auto token = inferred->token();
+        for (size_t i = 0; i < token->size(); i++)
+        {
+            auto w = token->ancestor(i)->wme;
+            if (!w->getDescription().empty()) described.push_back(w);
+        }
+    }
+    return described;
+}
+
+/**
+    The results of bulk builtins describe the values they were computed from, even after the
+    group changed.
+*/
+bool bulk_description()
+{
+    RuleParser p;
+    Reasoner reasoner;
+    auto rules = p.parseRules(
+        "[(?s <value> ?v), GROUP BY (?s), SumBulk(?sum ?v) -> (?s <sum> ?sum)]",
+        reasoner.net()
+    );
+
+    std::vector<AssertedEvidence::Ptr> evidences;
+    for (int v : { 3, 1, 2 })
+    {
+        evidences.push_back(std::make_shared<AssertedEvidence>(std::to_string(v)));
+        reasoner.addEvidence(
+            std::make_shared<Triple>("<s1>", "<value>", std::to_string(v)),
+            evidences.back());
+    }
+    reasoner.performInference();
+
+    auto findSum = [&]() -> WME::Ptr
+    {
+        for (auto wme : reasoner.getCurrentState().getWMEs())
+        {
+            auto triple = std::dynamic_pointer_cast<Triple>(wme);
+            if (triple && triple->predicate == "<sum>") return triple;
+        }
+        return nullptr;
+    };
+
+    auto sum = findSum();
+    if (!sum) return false;
+    auto results = describedWMEs(reasoner, sum);
+    if (results.size() != 1) return false;
+
+    std::string expected = "sum( " + std::to_string(1.f) + " " + std::to_string(2.f) + " " +
+                           std::to_string(3.f) + " ) = " + std::to_string(6.f);
+    if (results[0]->getDescription() != expected) return false;
+
+    // remove the 3, the old result must not change
+    reasoner.removeEvidence(evidences[0]);
+    reasoner.performInference();
+
+    if (results[0]->getDescription() != expected) return false;
+
+    sum = findSum();
+    if (!sum) return false;
+    auto updated = describedWMEs(reasoner, sum);
+    return updated.size() == 1 &&
+           updated[0]->getDescription() ==
+                "sum( " + std::to_string(1.f) + " " + std::to_string(2.f) + " ) = " +
+                std::to_string(3.f);
+}
+
+
 #define TEST(function) \
     { \
         bool ok = (function)(); \
@@ -273,5 +478,9 @@ int main()
     TEST(sum_bulk_retract);
     TEST(count);
     TEST(count_and_compare);
+    TEST(min_max_avg);
+    TEST(mul_bulk_zero);
+    TEST(bulk_magnitudes);
+    TEST(bulk_description);
     return failed;
 }
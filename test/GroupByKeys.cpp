@@ -0,0 +1,161 @@
+#include <iostream>
+
+#include "../rete-reasoner/Reasoner.hpp"
+#include "../rete-reasoner/RuleParser.hpp"
+#include "../rete-rdf/ReteRDF.hpp"
+
+#include "MutableWME.hpp"
+
+using namespace rete;
+
+/**
+    A value that can be compared, but has no std::hash.
+*/
+struct Label {
+    std::string str;
+    bool operator == (const Label& other) const { return str == other.str; }
+};
+
+/**
+    Accesses the value of a MutableWME as a Label
+*/
+class LabelAccessor : public Accessor<MutableWME, Label> {
+    bool equals(const AccessorBase& other) const override
+    {
+        return nullptr != dynamic_cast<const LabelAccessor*>(&other);
+    }
+
+    void getValue(MutableWME::Ptr wme, Label& value) const override
+    {
+        value.str = wme->value_;
+    }
+
+    LabelAccessor* clone() const override
+    {
+        auto acc = new LabelAccessor();
+        acc->index() = index_;
+        return acc;
+    }
+};
+
+class LabelNodeBuilder : public NodeBuilder {
+public:
+    LabelNodeBuilder() : NodeBuilder("Label", BuilderType::ALPHA)
+    {
+    }
+
+    void buildAlpha(ArgumentList& args, std::vector<AlphaNode::Ptr>& nodes) const override
+    {
+        if (args.size() != 1 || !args[0].isVariable() || args[0].getAccessor())
+            throw NodeBuilderException("invalid use of Label-condition");
+
+        nodes.push_back(MutableAlphaNode::Ptr(new MutableAlphaNode()));
+        args[0].bind(LabelAccessor::Ptr(new LabelAccessor()));
+    }
+};
+
+
+bool containsTriple(Reasoner& reasoner,
+                    const std::string& s, const std::string& p, const std::string& o)
+{
+    for (auto wme : reasoner.getCurrentState().getWMEs())
+    {
+        auto triple = std::dynamic_pointer_cast<Triple>(wme);
+        if (triple &&
+            triple->subject == s &&
+            triple->predicate == p &&
+            triple->object == o)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+    Groups MutableWMEs by their value, accessed through the given condition, and moves them
+    between the groups through UPDATEs. Returns 0 on success.
+*/
+int groupAndUpdate(const std::string& condition)
+{
+    RuleParser p;
+    p.registerNodeBuilder<MutableNodeBuilder>();
+    p.registerNodeBuilder<LabelNodeBuilder>();
+
+    Reasoner reasoner;
+    auto rules = p.parseRules(
+        "[" + condition + "(?v), (<some> <thing> ?o),"
+        " GROUP BY (?v), count(?n ?o) -> (<group> <size> ?n)]",
+        reasoner.net()
+    );
+
+    auto ev = std::make_shared<AssertedEvidence>("asserted");
+    reasoner.addEvidence(std::make_shared<Triple>("<some>", "<thing>", "<here>"), ev);
+
+    std::vector<MutableWME::Ptr> wmes;
+    for (auto value : { "x", "x", "y" })
+    {
+        auto wme = std::make_shared<MutableWME>();
+        wme->value_ = value;
+        wmes.push_back(wme);
+        reasoner.addEvidence(wme, ev);
+    }
+
+    auto update = [&](MutableWME::Ptr wme, const std::string& value)
+    {
+        wme->value_ = value;
+        reasoner.net().getRoot()->activate(wme, PropagationFlag::UPDATE);
+        reasoner.performInference();
+    };
+
+    // x: 2, y: 1
+    reasoner.performInference();
+    if (!containsTriple(reasoner, "<group>", "<size>", "2") ||
+        !containsTriple(reasoner, "<group>", "<size>", "1")) return 1;
+
+    // x: 3, a token that was alone in its group joins another one
+    update(wmes[2], "x");
+    if (!containsTriple(reasoner, "<group>", "<size>", "3") ||
+        containsTriple(reasoner, "<group>", "<size>", "1")) return 2;
+
+    // x: 2, z: 1
+    update(wmes[0], "z");
+    if (!containsTriple(reasoner, "<group>", "<size>", "2") ||
+        !containsTriple(reasoner, "<group>", "<size>", "1") ||
+        containsTriple(reasoner, "<group>", "<size>", "3")) return 3;
+
+    // z: 3, the last token of x joins the existing group of z
+    update(wmes[1], "z");
+    update(wmes[2], "z");
+    if (!containsTriple(reasoner, "<group>", "<size>", "3") ||
+        containsTriple(reasoner, "<group>", "<size>", "2") ||
+        containsTriple(reasoner, "<group>", "<size>", "1")) return 4;
+
+    // x: 1, y: 1, z: 1
+    update(wmes[0], "x");
+    update(wmes[1], "y");
+    if (!containsTriple(reasoner, "<group>", "<size>", "1") ||
+        containsTriple(reasoner, "<group>", "<size>", "3") ||
+        containsTriple(reasoner, "<group>", "<size>", "2")) return 5;
+
+    reasoner.removeEvidence(ev);
+    reasoner.performInference();
+    if (reasoner.getCurrentState().numWMEs() != 0) return 6;
+
+    return 0;
+}
+
+/**
+    The groups of a GroupBy are indexed by a hash of their values. Values that cannot be hashed
+    must still be grouped, and tokens must find their new group when their values change.
+*/
+int main()
+{
+    int result = groupAndUpdate("MutableWME");
+    if (result) return result;
+
+    result = groupAndUpdate("Label");
+    if (result) return 10 + result;
+
+    return 0;
+}
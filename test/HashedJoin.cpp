@@ -0,0 +1,92 @@
+#include <iostream>
+
+#include "../rete-core/ReteCore.hpp"
+#include "../rete-rdf/ReteRDF.hpp"
+
+using namespace rete;
+
+/**
+    GenericJoins on hashable values keep hash indexes on their parent memories.
+    Make sure the joins still find every match, no matter if the WMEs were
+    added before or after the join was connected, and that retractions are
+    handled correctly.
+*/
+int main()
+{
+    Network net;
+
+    /*
+        (predicate == "self"?) ____
+                                   ` (join on subject)
+        (predicate == "color"?) ---'
+    */
+    auto root = net.getRoot();
+    TripleTypeAlpha::Ptr typeCheck(new TripleTypeAlpha()); SetParent(root, typeCheck);
+
+    TripleAlpha::Ptr a1(new TripleAlpha(Triple::PREDICATE, "self")); SetParent(typeCheck, a1);
+    TripleAlpha::Ptr b1(new TripleAlpha(Triple::PREDICATE, "color")); SetParent(typeCheck, b1);
+
+    auto a1mem = std::make_shared<AlphaMemory>();
+    auto b1mem = std::make_shared<AlphaMemory>();
+    SetParent(a1, a1mem);
+    SetParent(b1, b1mem);
+
+    AlphaBetaAdapter::Ptr ab(new AlphaBetaAdapter());
+    SetParents(nullptr, a1mem, ab);
+    auto abmem = std::make_shared<BetaMemory>();
+    SetParent(ab, abmem);
+
+    // some knowledge before the join exists
+    std::vector<Triple::Ptr> selfs, colors;
+    for (int i = 0; i < 10; i++)
+    {
+        std::string name = "B" + std::to_string(i);
+        selfs.push_back(std::make_shared<Triple>(name, "self", name));
+        colors.push_back(std::make_shared<Triple>(name, "color", "red"));
+        colors.push_back(std::make_shared<Triple>(name, "color", "blue"));
+    }
+
+    for (int i = 0; i < 5; i++)
+    {
+        root->activate(selfs[i], rete::ASSERT);
+        root->activate(colors[2*i], rete::ASSERT);
+    }
+
+    GenericJoin::Ptr j1(new GenericJoin());
+    TripleAccessor::Ptr acc0(new TripleAccessor(Triple::SUBJECT));
+    acc0->index() = 0;
+    TripleAccessor::Ptr acc1(new TripleAccessor(Triple::SUBJECT));
+    j1->addCheck(acc0, acc1);
+
+    SetParents(abmem, b1mem, j1);
+    auto j1mem = std::make_shared<BetaMemory>();
+    SetParent(j1, j1mem);
+
+    // B0..B4 are red
+    if (j1mem->size() != 5) return 1;
+
+    // and blue
+    for (int i = 0; i < 5; i++) root->activate(colors[2*i+1], rete::ASSERT);
+    if (j1mem->size() != 10) return 2;
+
+    // more knowledge, first colors then selfs
+    for (int i = 10; i < 20; i++) root->activate(colors[i], rete::ASSERT);
+    if (j1mem->size() != 10) return 3;
+    for (int i = 5; i < 10; i++) root->activate(selfs[i], rete::ASSERT);
+    if (j1mem->size() != 20) return 4;
+
+    // remove by equal but different instances
+    root->activate(std::make_shared<Triple>("B3", "self", "B3"), rete::RETRACT);
+    if (j1mem->size() != 18) return 5;
+    root->activate(std::make_shared<Triple>("B7", "color", "blue"), rete::RETRACT);
+    if (j1mem->size() != 17) return 6;
+
+    for (auto token : *j1mem)
+    {
+        auto self = std::static_pointer_cast<Triple>(token->parent->wme);
+        auto color = std::static_pointer_cast<Triple>(token->wme);
+        if (self->subject != color->subject) return 7;
+    }
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <iostream>
+#include "../rete-reasoner/RuleParser.hpp"
+#include "../rete-reasoner/Reasoner.hpp"
+#include "../rete-reasoner/AssertedEvidence.hpp"
+#include "../rete-rdf/ReteRDF.hpp"
+
+using namespace rete;
+
+bool contains(Reasoner& reasoner, const std::string& s, const std::string& p, const std::string& o)
+{
+    for (auto wme : reasoner.getCurrentState().getWMEs())
+    {
+        auto triple = std::dynamic_pointer_cast<Triple>(wme);
+        if (triple && triple->subject == s && triple->predicate == p && triple->object == o)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+    Evidences for WMEs that are already known are only recorded, the WMEs are not propagated
+    through the network again. Still, the WME must stay as long as any of its evidences does.
+*/
+int knownWMEs()
+{
+    RuleParser parser;
+    Reasoner reasoner;
+    auto rules = parser.parseRules("[copy: (?a <p> ?b) -> (?a <q> ?b)]", reasoner.net());
+
+    size_t asserts = 0;
+    reasoner.setCallback(
+        [&asserts](WME::Ptr, PropagationFlag flag)
+        {
+            if (flag == rete::ASSERT) asserts++;
+        }
+    );
+
+    auto first = std::make_shared<AssertedEvidence>("first");
+    auto second = std::make_shared<AssertedEvidence>("second");
+    auto third = std::make_shared<AssertedEvidence>("third");
+
+    reasoner.addEvidence(std::make_shared<Triple>("<x>", "<p>", "<y>"), first);
+    reasoner.performInference();
+    if (reasoner.getCurrentState().numWMEs() != 2 || asserts != 2) return 1;
+
+    // equal, but not identical triples, added one by one and as a batch
+    NodeStatistics::setEnabled(true);
+    reasoner.net().resetStatistics();
+
+    reasoner.addEvidence(std::make_shared<Triple>("<x>", "<p>", "<y>"), second);
+    reasoner.addEvidence({{std::make_shared<Triple>("<x>", "<p>", "<y>"), third}});
+
+    auto stats = reasoner.net().getStatistics();
+    NodeStatistics::setEnabled(false);
+
+    if (stats.numActivations() != 0) return 2;
+    if (!reasoner.net().getAgenda()->empty()) return 3;
+    if (asserts != 2) return 4;
+    if (reasoner.getCurrentState().numWMEs() != 2) return 5;
+    if (reasoner.getCurrentState().numEvidences() != 4) return 6;
+
+    // the WME holds until all of its evidences are gone
+    for (auto evidence : { second, first })
+    {
+        reasoner.removeEvidence(evidence);
+        reasoner.performInference();
+        if (!contains(reasoner, "<x>", "<p>", "<y>") ||
+            !contains(reasoner, "<x>", "<q>", "<y>")) return 7;
+    }
+
+    reasoner.removeEvidence(third);
+    reasoner.performInference();
+    if (reasoner.getCurrentState().numWMEs() != 0) return 8;
+
+    return 0;
+}
+
+/**
+    A symmetric rule re-derives the asserted fact it started from. This evidence is added to the
+    known WME without touching its rank, which must still let the reasoner tell facts that are
+    derived from others apart from facts that only support each other in a loop.
+*/
+int loops(bool removeFirstBeforeSecond)
+{
+    RuleParser parser;
+    Reasoner reasoner;
+    auto rules = parser.parseRules("[sym: (?a <knows> ?b) -> (?b <knows> ?a)]", reasoner.net());
+
+    auto first = std::make_shared<AssertedEvidence>("first");
+    auto second = std::make_shared<AssertedEvidence>("second");
+
+    // (<a> <knows> <b>) -> (<b> <knows> <a>) -> (<a> <knows> <b>) again
+    reasoner.addEvidence(std::make_shared<Triple>("<a>", "<knows>", "<b>"), first);
+    reasoner.performInference();
+    if (reasoner.getCurrentState().numWMEs() != 2) return 1;
+
+    // the inferred fact is asserted, too
+    reasoner.addEvidence(std::make_shared<Triple>("<b>", "<knows>", "<a>"), second);
+    reasoner.performInference();
+    if (reasoner.getCurrentState().numWMEs() != 2) return 2;
+
+    // both facts can still be derived from the remaining assertion
+    reasoner.removeEvidence(removeFirstBeforeSecond ? first : second);
+    reasoner.performInference();
+    if (!contains(reasoner, "<a>", "<knows>", "<b>") ||
+        !contains(reasoner, "<b>", "<knows>", "<a>")) return 3;
+
+    // only the loop is left
+    reasoner.removeEvidence(removeFirstBeforeSecond ? second : first);
+    reasoner.performInference();
+    if (reasoner.getCurrentState().numWMEs() != 0) return 4;
+
+    // and it works again afterwards
+    reasoner.addEvidence(std::make_shared<Triple>("<b>", "<knows>", "<a>"), second);
+    reasoner.performInference();
+    if (!contains(reasoner, "<a>", "<knows>", "<b>")) return 5;
+
+    reasoner.removeEvidence(second);
+    reasoner.performInference();
+    if (reasoner.getCurrentState().numWMEs() != 0) return 6;
+
+    return 0;
+}
+
+int main()
+{
+    int result = knownWMEs();
+    if (result) return result;
+
+    result = loops(true);
+    if (result) return 10 + result;
+
+    result = loops(false);
+    if (result) return 20 + result;
+
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include <iostream>
+#include "../rete-reasoner/RuleParser.hpp"
+#include "../rete-reasoner/Reasoner.hpp"
+#include "../rete-reasoner/AssertedEvidence.hpp"
+#include "../rete-rdf/ReteRDF.hpp"
+
+using namespace rete;
+
+/**
+    Removing the base of a long chain of inferences that loops back onto itself must neither
+    recurse along the chain, nor remove facts that can still be derived on another way.
+*/
+int main()
+{
+    RuleParser parser;
+    Reasoner reasoner;
+    auto rules = parser.parseRules(
+        "[reach: (?a <reach> ?b), (?b <edge> ?c) -> (?a <reach> ?c)]",
+        reasoner.net());
+
+    // a path <n0> <-> <n1> <-> ... <-> <nk>, in both directions: everything that is reachable
+    // from somewhere is also inferred through all its neighbours.
+    const int k = 20000;
+    auto edges = std::make_shared<AssertedEvidence>("edges");
+    for (int i = 0; i < k; i++)
+    {
+        std::string a = "<n" + std::to_string(i) + ">";
+        std::string b = "<n" + std::to_string(i + 1) + ">";
+        reasoner.addEvidence(std::make_shared<Triple>(a, "<edge>", b), edges);
+        reasoner.addEvidence(std::make_shared<Triple>(b, "<edge>", a), edges);
+    }
+
+    auto start = std::make_shared<AssertedEvidence>("start");
+    auto other = std::make_shared<AssertedEvidence>("other");
+    reasoner.addEvidence(std::make_shared<Triple>("<n0>", "<reach>", "<n0>"), start);
+    reasoner.addEvidence(std::make_shared<Triple>("<n0>", "<reach>", "<n" + std::to_string(k) + ">"), other);
+    reasoner.performInference();
+
+    std::cout << reasoner.getCurrentState().numWMEs() << " WMEs" << std::endl;
+    if (reasoner.getCurrentState().numWMEs() != 2 * k + k + 1) return 1;
+
+    // every <reach> can still be derived from the other end of the path
+    reasoner.removeEvidence(start);
+    reasoner.performInference();
+    if (reasoner.getCurrentState().numWMEs() != 2 * k + k + 1) return 2;
+
+    // now only loops are left
+    reasoner.removeEvidence(other);
+    reasoner.performInference();
+    if (reasoner.getCurrentState().numWMEs() != 2 * k) return 3;
+
+    // and everything works as usual afterwards
+    reasoner.addEvidence(std::make_shared<Triple>("<n0>", "<reach>", "<n0>"), start);
+    reasoner.performInference();
+    if (reasoner.getCurrentState().numWMEs() != 2 * k + k + 1) return 4;
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <iostream>
+#include "../rete-core/MemoryUsageVisitor.hpp"
+#include "../rete-reasoner/RuleParser.hpp"
+#include "../rete-reasoner/Reasoner.hpp"
+#include "../rete-reasoner/AssertedEvidence.hpp"
+#include "../rete-rdf/ReteRDF.hpp"
+
+using namespace rete;
+
+size_t usageOf(const ParsedRule::Ptr& rule)
+{
+    MemoryUsageVisitor usage;
+    rule->accept(usage);
+    return usage.total();
+}
+
+/**
+    The memory usage reported for the network, the rules and the reasoner must grow with the data
+    they hold, point at the rules that hold the most, and shrink again when the data is removed.
+*/
+int main()
+{
+    RuleParser parser;
+    Reasoner reasoner;
+    auto rules = parser.parseRules(
+        "[cross: (?a <left> ?x), (?b <right> ?y) -> (?a <crossed> ?b)]"
+        "[lonely: (?a <left> ?x), noValue { (?a <right> ?y) } -> (?a <lonely> \"yes\")]"
+        "[count: (?a <left> ?x), GROUP BY (?x), count(?c ?a) -> (?x <count> ?c)]",
+        reasoner.net());
+    if (rules.size() != 3) return 1;
+
+    size_t emptyReasoner = reasoner.getMemoryUsage();
+    size_t emptyCross = usageOf(rules[0]);
+
+    auto ev = std::make_shared<AssertedEvidence>("data");
+    for (int i = 0; i < 100; i++)
+    {
+        std::string a = "<n" + std::to_string(i) + ">";
+        reasoner.addEvidence(std::make_shared<Triple>(a, "<left>", "<x" + std::to_string(i % 3) + ">"), ev);
+        reasoner.addEvidence(std::make_shared<Triple>(a + "r", "<right>", "<y>"), ev);
+    }
+
+    // the agenda holds the matches until they are processed
+    size_t agenda = reasoner.net().getAgenda()->getMemoryUsage();
+    if (agenda == 0) return 2;
+
+    reasoner.performInference();
+    if (reasoner.net().getAgenda()->getMemoryUsage() >= agenda) return 3;
+
+    // 100 * 100 matches of the cross product are by far the most
+    size_t cross = usageOf(rules[0]);
+    size_t lonely = usageOf(rules[1]);
+    size_t count = usageOf(rules[2]);
+    std::cout << "cross: " << cross << ", lonely: " << lonely << ", count: " << count << std::endl;
+    if (cross <= emptyCross) return 4;
+    if (cross <= lonely || cross <= count) return 5;
+
+    // the network contains every rule, and the shared nodes are counted only once. Besides the
+    // rules, it only has the memory of its root, which holds every WME.
+    MemoryUsageVisitor all;
+    reasoner.net().accept(all);
+    MemoryUsageVisitor combined;
+    for (auto& rule : rules) rule->accept(combined);
+    if (all.numNodes() != combined.numNodes() + 1) return 6;
+    if (all.total() <= combined.total()) return 7;
+    if (combined.total() >= cross + lonely + count) return 8;
+    if (all.betaMemories() == 0 || all.alphaMemories() == 0) return 9;
+
+    size_t full = reasoner.getMemoryUsage();
+    std::cout << "reasoner: " << emptyReasoner << " -> " << full << std::endl;
+    if (full <= all.total() + reasoner.getCurrentState().getMemoryUsage() - 1) return 10;
+
+    // released again with the data -- but not everything, as e.g. the containers keep their
+    // buckets
+    reasoner.removeEvidence(ev);
+    reasoner.performInference();
+    std::cout << "after removal: " << usageOf(rules[0]) << ", " << reasoner.getMemoryUsage() << std::endl;
+    if (usageOf(rules[0]) >= cross / 2) return 11;
+    if (reasoner.getMemoryUsage() >= full / 2) return 12;
+
+    return 0;
+}
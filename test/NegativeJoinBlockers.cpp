@@ -0,0 +1,100 @@
+#include <iostream>
+
+#include "../rete-core/ReteCore.hpp"
+#include "../rete-rdf/ReteRDF.hpp"
+
+using namespace rete;
+
+/**
+    Negative joins count the wmes that block a token. A token must only be
+    released once the last of its blockers is retracted, no matter in which
+    order they vanish, and retracted tokens must not come back.
+*/
+int main()
+{
+    Network net;
+
+    /*
+        (predicate == "self"?) ____
+                                   ` (negative join on subject)
+        (predicate == "color"?) ---'
+    */
+    auto root = net.getRoot();
+    TripleTypeAlpha::Ptr typeCheck(new TripleTypeAlpha()); SetParent(root, typeCheck);
+
+    TripleAlpha::Ptr a1(new TripleAlpha(Triple::PREDICATE, "self")); SetParent(typeCheck, a1);
+    TripleAlpha::Ptr b1(new TripleAlpha(Triple::PREDICATE, "color")); SetParent(typeCheck, b1);
+
+    auto a1mem = std::make_shared<AlphaMemory>();
+    auto b1mem = std::make_shared<AlphaMemory>();
+    SetParent(a1, a1mem);
+    SetParent(b1, b1mem);
+
+    AlphaBetaAdapter::Ptr ab(new AlphaBetaAdapter());
+    SetParents(nullptr, a1mem, ab);
+    auto abmem = std::make_shared<BetaMemory>();
+    SetParent(ab, abmem);
+
+    GenericJoin::Ptr j1(new GenericJoin());
+    TripleAccessor::Ptr acc0(new TripleAccessor(Triple::SUBJECT));
+    acc0->index() = 0;
+    TripleAccessor::Ptr acc1(new TripleAccessor(Triple::SUBJECT));
+    j1->addCheck(acc0, acc1);
+    j1->setNegative(true);
+
+    SetParents(abmem, b1mem, j1);
+    auto j1mem = std::make_shared<BetaMemory>();
+    SetParent(j1, j1mem);
+
+    std::vector<Triple::Ptr> selfs;
+    for (int i = 0; i < 4; i++)
+    {
+        std::string name = "B" + std::to_string(i);
+        selfs.push_back(std::make_shared<Triple>(name, "self", name));
+        root->activate(selfs.back(), rete::ASSERT);
+    }
+
+    // nothing has a color yet
+    if (j1mem->size() != 4) return 1;
+
+    // B0 gets three colors, B1 one.
+    auto red = std::make_shared<Triple>("B0", "color", "red");
+    auto green = std::make_shared<Triple>("B0", "color", "green");
+    auto blue = std::make_shared<Triple>("B0", "color", "blue");
+    auto b1red = std::make_shared<Triple>("B1", "color", "red");
+    root->activate(red, rete::ASSERT);
+    root->activate(green, rete::ASSERT);
+    root->activate(b1red, rete::ASSERT);
+    if (j1mem->size() != 2) return 2;
+    root->activate(blue, rete::ASSERT);
+    if (j1mem->size() != 2) return 3;
+
+    // releasing B1 must not affect B0
+    root->activate(std::make_shared<Triple>("B1", "color", "red"), rete::RETRACT);
+    if (j1mem->size() != 3) return 4;
+
+    // B0 stays blocked until the last color is gone
+    root->activate(green, rete::RETRACT);
+    if (j1mem->size() != 3) return 5;
+    root->activate(red, rete::RETRACT);
+    if (j1mem->size() != 3) return 6;
+    root->activate(blue, rete::RETRACT);
+    if (j1mem->size() != 4) return 7;
+
+    // a token that is retracted while blocked must not be released later
+    root->activate(red, rete::ASSERT);
+    root->activate(green, rete::ASSERT);
+    if (j1mem->size() != 3) return 8;
+    root->activate(selfs[0], rete::RETRACT);
+    root->activate(red, rete::RETRACT);
+    root->activate(green, rete::RETRACT);
+    if (j1mem->size() != 3) return 9;
+
+    for (auto token : *j1mem)
+    {
+        auto self = std::static_pointer_cast<Triple>(token->parent->wme);
+        if (self->subject == "B0") return 10;
+    }
+
+    return 0;
+}
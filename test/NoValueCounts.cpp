@@ -0,0 +1,80 @@
+#include <iostream>
+
+#include "../rete-reasoner/Reasoner.hpp"
+#include "../rete-reasoner/RuleParser.hpp"
+#include "../rete-reasoner/AssertedEvidence.hpp"
+#include "../rete-rdf/Triple.hpp"
+
+using namespace rete;
+
+/**
+    The noValue node counts the matches of its sub-conditions per token. Make
+    sure that a token is only released when the last match vanishes, also if
+    the rule was added after the data.
+*/
+int main()
+{
+    RuleParser p;
+    Reasoner reasoner;
+
+    Triple::Ptr lot(new Triple("<p1>", "<type>", "<parkinglot>"));
+    Triple::Ptr c1on(new Triple("<c1>", "<parksOn>", "<p1>"));
+    Triple::Ptr c1red(new Triple("<c1>", "<color>", "<red>"));
+    Triple::Ptr c2on(new Triple("<c2>", "<parksOn>", "<p1>"));
+    Triple::Ptr c2red(new Triple("<c2>", "<color>", "<red>"));
+    AssertedEvidence::Ptr ev0(new AssertedEvidence("Evidence0"));
+    AssertedEvidence::Ptr ev1(new AssertedEvidence("Evidence1"));
+    AssertedEvidence::Ptr ev2(new AssertedEvidence("Evidence2"));
+
+    reasoner.addEvidence(lot, ev0);
+    reasoner.addEvidence(c1on, ev0);
+    reasoner.addEvidence(c2on, ev0);
+    reasoner.addEvidence(c1red, ev1);
+    reasoner.addEvidence(c2red, ev2);
+    reasoner.performInference();
+
+    // two red cars on the lot before the rule exists
+    auto rules = p.parseRules(
+        "[rule1: (?p <type> <parkinglot>), noValue { (?c <parksOn> ?p), (?c <color> <red>) } -> (<thereis> <nothing-red-on> ?p)]",
+        reasoner.net()
+    );
+    reasoner.performInference();
+
+    Triple::Ptr result(new Triple("<thereis>", "<nothing-red-on>", "<p1>"));
+    auto holds = [&]() -> bool
+    {
+        for (auto wme : reasoner.getCurrentState().getWMEs())
+        {
+            if (*wme == *result) return true;
+        }
+        return false;
+    };
+
+    if (holds()) return 1;
+
+    // one red car left
+    reasoner.removeEvidence(ev1);
+    reasoner.performInference();
+    if (holds()) return 2;
+
+    // none left
+    reasoner.removeEvidence(ev2);
+    reasoner.performInference();
+    if (!holds()) return 3;
+
+    // and back again
+    reasoner.addEvidence(c1red, ev1);
+    reasoner.addEvidence(c2red, ev2);
+    reasoner.performInference();
+    if (holds()) return 4;
+
+    reasoner.removeEvidence(ev2);
+    reasoner.performInference();
+    if (holds()) return 5;
+
+    reasoner.removeEvidence(ev1);
+    reasoner.performInference();
+    if (!holds()) return 6;
+
+    return 0;
+}
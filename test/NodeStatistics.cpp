@@ -0,0 +1,96 @@
+#include <iostream>
+#include "../rete-core/NodeStatisticsVisitor.hpp"
+#include "../rete-reasoner/RuleParser.hpp"
+#include "../rete-reasoner/Reasoner.hpp"
+#include "../rete-reasoner/AssertedEvidence.hpp"
+#include "../rete-rdf/ReteRDF.hpp"
+
+using namespace rete;
+
+NodeStatistics::Counts statsOf(const ParsedRule::Ptr& rule)
+{
+    NodeStatisticsVisitor stats;
+    rule->accept(stats);
+    return stats.total();
+}
+
+void addData(Reasoner& reasoner, Evidence::Ptr ev)
+{
+    for (int i = 0; i < 50; i++)
+    {
+        std::string a = "<n" + std::to_string(i) + ">";
+        reasoner.addEvidence(std::make_shared<Triple>(a, "<num>", std::to_string(i % 7)), ev);
+        if (i % 3) reasoner.addEvidence(std::make_shared<Triple>(a, "<type>", "<T>"), ev);
+    }
+    reasoner.performInference();
+}
+
+/**
+    Nothing is recorded unless the statistics are enabled. When they are, the counters of the
+    rules must reflect the work they did, and show up in the dot-representation of the network.
+*/
+int main()
+{
+    RuleParser parser;
+    Reasoner reasoner;
+    auto rules = parser.parseRules(
+        "[less: (?a <num> ?n), (?b <num> ?m), lt(?n ?m) -> (?a <lessThan> ?b)]"
+        "[untyped: (?a <num> ?n), noValue { (?a <type> <T>) } -> (?a <untyped> \"yes\")]"
+        "[count: (?a <num> ?n), GROUP BY (?n), count(?c ?a) -> (?n <count> ?c)]",
+        reasoner.net());
+    if (rules.size() != 3) return 1;
+
+    auto ev = std::make_shared<AssertedEvidence>("data");
+    addData(reasoner, ev);
+    if (!reasoner.net().getStatistics().empty()) return 2;
+    if (reasoner.net().toDot().find("xlabel") != std::string::npos) return 3;
+
+    NodeStatistics::setEnabled(true);
+    if (!NodeStatistics::isCompiledIn())
+    {
+        // nothing to test, but the switch must not enable anything
+        std::cout << "node statistics are not compiled in" << std::endl;
+        return NodeStatistics::isEnabled() ? 4 : 0;
+    }
+
+    reasoner.removeEvidence(ev);
+    reasoner.performInference();
+    auto removal = reasoner.net().getStatistics();
+    if (removal.activations[PropagationFlag::RETRACT] == 0) return 5;
+    if (removal.tokensRetracted == 0 || removal.tokensCreated != 0) return 6;
+
+    reasoner.net().resetStatistics();
+    if (!reasoner.net().getStatistics().empty()) return 7;
+
+    NodeStatistics::setTiming(true);
+    addData(reasoner, ev);
+    NodeStatistics::setTiming(false);
+
+    // every pair of numbers is checked by lt, but only some are less
+    auto less = statsOf(rules[0]);
+    auto untyped = statsOf(rules[1]);
+    auto count = statsOf(rules[2]);
+    std::cout << "less:\n" << less.toString() << std::endl;
+    std::cout << "untyped:\n" << untyped.toString() << std::endl;
+    std::cout << "count:\n" << count.toString() << std::endl;
+
+    if (less.checks < 50 * 50 || less.matches == 0 || less.matches >= less.checks) return 8;
+    if (less.tokensCreated == 0 || less.nanoseconds == 0) return 9;
+    if (untyped.numActivations() == 0 || count.numActivations() == 0) return 10;
+    if (untyped.numActivations() >= less.numActivations()) return 11;
+
+    // the network contains all of it
+    auto all = reasoner.net().getStatistics();
+    if (all.checks < less.checks || all.numActivations() < less.numActivations()) return 12;
+
+    auto dot = reasoner.net().toDot();
+    if (dot.find("xlabel=\"A: ") == std::string::npos) return 13;
+
+    // when disabled again, the counters stay as they are
+    NodeStatistics::setEnabled(false);
+    reasoner.removeEvidence(ev);
+    reasoner.performInference();
+    if (statsOf(rules[0]).numActivations() != less.numActivations()) return 14;
+
+    return 0;
+}
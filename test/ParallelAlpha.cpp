@@ -0,0 +1,130 @@
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+#include "../rete-reasoner/RuleParser.hpp"
+#include "../rete-reasoner/Reasoner.hpp"
+#include "../rete-reasoner/AssertedEvidence.hpp"
+#include "../rete-rdf/ReteRDF.hpp"
+
+using namespace rete;
+
+const std::string rules =
+    "[pq: (?a <p> ?b), (?b <q> ?c) -> (?a <pq> ?c)]"
+    "[self: (?a <p> ?a) -> (?a <selfish> \"yes\")]"
+    "[typed: (?a <type> <T>), (?a <p> ?b), (?b <type> <T>) -> (?a <pT> ?b)]"
+    "[lonely: (?a <type> <T>), noValue { (?a <q> ?x) } -> (?a <lonely> \"yes\")]"
+    "[cross: (?a <left> ?x), (?b <right> ?y) -> (?a <crossed> ?b)]";
+
+using Batch = std::vector<std::pair<WME::Ptr, Evidence::Ptr>>;
+
+/**
+    Adds the same large batches to reasoners that process them with a different number of
+    threads, in the alpha network as well as in the joins. Everything that happens afterwards --
+    including the order in which the inferences are made -- must not depend on the number of
+    threads.
+*/
+std::vector<std::string> run(size_t threads, const std::vector<Batch>& batches)
+{
+    RuleParser parser;
+    Reasoner reasoner;
+    auto parsed = parser.parseRules(rules, reasoner.net());
+    reasoner.setNumThreads(threads);
+
+    std::vector<std::string> log;
+    reasoner.setCallback(
+        [&log](WME::Ptr wme, PropagationFlag flag)
+        {
+            log.push_back(std::to_string(flag) + wme->toString());
+        }
+    );
+
+    for (auto& batch : batches)
+    {
+        reasoner.addEvidence(batch);
+        reasoner.performInference();
+        log.push_back(std::to_string(reasoner.getCurrentState().numWMEs()));
+    }
+    return log;
+}
+
+/**
+    Records the threads it is activated on. Only splits batches across threads if it says it is
+    safe to do so.
+*/
+class RecordingAlpha : public AlphaNode {
+    bool concurrent_;
+public:
+    std::mutex mutex_;
+    std::set<std::thread::id> threads_;
+
+    RecordingAlpha(bool concurrent) : concurrent_(concurrent) {}
+
+    void activate(WME::Ptr wme, PropagationFlag flag) override
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            threads_.insert(std::this_thread::get_id());
+        }
+        propagate(wme, flag);
+    }
+
+    bool isConcurrent() const override { return concurrent_; }
+    bool operator == (const AlphaNode& other) const override { return this == &other; }
+};
+
+/**
+    Returns the number of threads a RecordingAlpha below the root was activated on for a large
+    batch.
+*/
+size_t recordThreads(bool concurrent, const Batch& batch)
+{
+    Reasoner reasoner;
+    reasoner.setNumThreads(4);
+    auto node = std::make_shared<RecordingAlpha>(concurrent);
+    SetParent(reasoner.net().getRoot(), node);
+
+    reasoner.addEvidence(batch);
+    reasoner.performInference();
+
+    if (node->threads_.empty()) return 0;
+    if (!concurrent && *node->threads_.begin() != std::this_thread::get_id()) return 0;
+    return node->threads_.size();
+}
+
+int main()
+{
+    auto ev = std::make_shared<AssertedEvidence>("batch");
+    Batch batch, lefts, rights;
+    for (int i = 0; i < 3000; i++)
+    {
+        std::string a = "<n" + std::to_string(i) + ">";
+        std::string b = "<n" + std::to_string((i * 7) % 3000) + ">";
+        std::string c = "<n" + std::to_string((i * 13) % 3000) + ">";
+
+        batch.push_back({std::make_shared<Triple>(a, "<p>", b), ev});
+        if (i % 3) batch.push_back({std::make_shared<Triple>(b, "<q>", c), ev});
+        if (i % 2) batch.push_back({std::make_shared<Triple>(a, "<type>", "<T>"), ev});
+    }
+
+    // a join without any check, which needs to check every combination of the two batches
+    for (int i = 0; i < 120; i++)
+    {
+        lefts.push_back({std::make_shared<Triple>("<l" + std::to_string(i) + ">", "<left>", "<x>"), ev});
+        rights.push_back({std::make_shared<Triple>("<r" + std::to_string(i) + ">", "<right>", "<y>"), ev});
+    }
+
+    auto sequential = run(1, {batch, lefts, rights});
+    std::cout << sequential.size() << " log entries, " << sequential.back() << " WMEs" << std::endl;
+
+    for (size_t threads : {2, 4, 7})
+    {
+        if (run(threads, {batch, lefts, rights}) != sequential) return threads;
+    }
+
+    // custom nodes are only activated on multiple threads if they opt in
+    if (recordThreads(false, batch) != 1) return 10;
+    if (recordThreads(true, batch) < 2) return 11;
+
+    return 0;
+}
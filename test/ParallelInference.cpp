@@ -0,0 +1,90 @@
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include "../rete-reasoner/RuleParser.hpp"
+#include "../rete-reasoner/Reasoner.hpp"
+#include "../rete-reasoner/AssertedEvidence.hpp"
+#include "../rete-rdf/ReteRDF.hpp"
+
+using namespace rete;
+
+const std::string rules =
+    "[subclass: (?a <subClassOf> ?b), (?b <subClassOf> ?c) -> (?a <subClassOf> ?c)]"
+    "[type: (?x <type> ?a), (?a <subClassOf> ?b) -> (?x <type> ?b)]"
+    "[root: (?x <type> ?a), noValue { (?a <subClassOf> ?b) } -> (?x <rootType> ?a)]"
+    "[print: (?x <type> <C0>) -> (?x <isC0> \"yes\")]";
+
+/**
+    Runs the inference with the given number of threads, and logs everything the reasoner does.
+*/
+std::vector<std::string> run(size_t threads, size_t maxSteps = 0)
+{
+    RuleParser parser;
+    Reasoner reasoner;
+    auto parsed = parser.parseRules(rules, reasoner.net());
+    reasoner.setNumThreads(threads);
+
+    std::vector<std::string> log;
+    reasoner.setCallback(
+        [&log](WME::Ptr wme, PropagationFlag flag)
+        {
+            log.push_back(std::to_string(flag) + wme->toString());
+        }
+    );
+
+    auto ev = std::make_shared<AssertedEvidence>("data");
+    for (int i = 0; i < 20; i++)
+    {
+        std::string c = "<C" + std::to_string(i) + ">";
+        std::string super = "<C" + std::to_string(i / 2) + ">";
+        if (i > 0) reasoner.addEvidence(std::make_shared<Triple>(c, "<subClassOf>", super), ev);
+
+        for (int j = 0; j < 5; j++)
+        {
+            std::string x = "<x" + std::to_string(i) + "_" + std::to_string(j) + ">";
+            reasoner.addEvidence(std::make_shared<Triple>(x, "<type>", c), ev);
+        }
+    }
+
+    try
+    {
+        reasoner.performInference(maxSteps);
+    }
+    catch (std::runtime_error&)
+    {
+        log.push_back("exceeded");
+    }
+    log.push_back(std::to_string(reasoner.getCurrentState().numWMEs()));
+
+    // removing things afterwards must still work as usual. The order in which the inference
+    // loops are cleaned up depends on the addresses of the WMEs, so only compare what is removed.
+    size_t removalStart = log.size();
+    reasoner.removeEvidence(std::make_shared<Triple>("<C1>", "<subClassOf>", "<C0>"), ev);
+    reasoner.performInference();
+    std::sort(log.begin() + removalStart, log.end());
+    log.push_back(std::to_string(reasoner.getCurrentState().numWMEs()));
+
+    return log;
+}
+
+/**
+    Executing the productions of the agenda concurrently must not change anything: Neither the
+    results, nor the order in which WMEs are inferred, nor the step at which maxSteps is
+    exceeded.
+*/
+int main()
+{
+    auto sequential = run(1);
+    std::cout << sequential.size() << " log entries" << std::endl;
+
+    for (size_t threads : {2, 4, 7})
+    {
+        if (run(threads) != sequential) return 1;
+    }
+
+    auto limited = run(1, 100);
+    if (limited == sequential) return 2;
+    if (run(4, 100) != limited) return 3;
+
+    return 0;
+}
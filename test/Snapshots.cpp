@@ -0,0 +1,261 @@
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include "../rete-reasoner/RuleParser.hpp"
+#include "../rete-reasoner/Reasoner.hpp"
+#include "../rete-reasoner/AssertedEvidence.hpp"
+#include "../rete-rdf/ReteRDF.hpp"
+
+using namespace rete;
+
+/**
+    Reads everything an explanation contains: The tokens of the inferred evidences and the WMEs
+    in them, and the entries of token groups.
+*/
+class ReadingVisitor : public ExplanationVisitor {
+public:
+    size_t read = 0;
+
+    bool wantsTokenGroups() const override { return true; }
+    void visit(TokenGroup::Ptr group, Token::Ptr token, WME::Ptr wme) override
+    {
+        read += group->token_.size() + token->size() + wme->toString().size();
+    }
+
+    void visit(WMESupportedBy& support, size_t) override { read += support.evidences_.size(); }
+    void visit(WME::Ptr wme, size_t) override { read += wme->toString().size(); }
+    void visit(Evidence::Ptr evidence, size_t) override { read += evidence->toString().size(); }
+    void visit(AssertedEvidence::Ptr evidence, size_t) override { read += evidence->toString().size(); }
+    void visit(InferredEvidence::Ptr evidence, size_t) override
+    {
+        auto token = evidence->token();
+        for (size_t i = 0; i < token->size(); i++)
+        {
+            read += token->ancestor(i)->wme->toString().size();
+        }
+    }
+};
+
+/**
+    The network changes the tokens of GROUP BYs and builtins in place, the snapshots must not.
+    Every snapshot must contain the sum of the scores it contains, while the scores change.
+*/
+int groupsAndBuiltins()
+{
+    RuleParser parser;
+    Reasoner reasoner;
+    auto rules = parser.parseRules(
+        "[(?player <scored> ?points), GROUP BY (?player), SumBulk(?total ?points),"
+        " sum(?double ?total ?total)"
+        " -> (?player <total> ?total), (?player <double> ?double)]",
+        reasoner.net());
+
+    auto ev = std::make_shared<AssertedEvidence>("scores");
+    auto score = [](int i) { return std::make_shared<Triple>("<p1>", "<scored>", std::to_string(i)); };
+    reasoner.addEvidence(score(0), ev);
+    reasoner.performInference();
+    reasoner.publishSnapshot();
+
+    std::atomic<bool> done(false);
+    std::atomic<int> errors(0);
+    std::thread reader(
+        [&]()
+        {
+            while (!done)
+            {
+                auto snapshot = reasoner.getSnapshot();
+                float sum = 0;
+                int totals = 0;
+                for (auto wme : snapshot->getWMEs())
+                {
+                    auto triple = std::static_pointer_cast<Triple>(wme);
+                    if (triple->predicate == "<scored>") sum += std::stof(triple->object);
+                }
+                for (auto wme : snapshot->getWMEs())
+                {
+                    auto triple = std::static_pointer_cast<Triple>(wme);
+                    if (triple->predicate == "<total>")
+                    {
+                        totals++;
+                        if (std::stof(triple->object) != sum) errors++;
+                    }
+
+                    ReadingVisitor visitor;
+                    snapshot->traverseExplanation(wme, visitor);
+                    if (!visitor.read) errors++;
+                }
+                if (totals != 1) errors++;
+            }
+        }
+    );
+
+    for (int i = 1; i < 100; i++)
+    {
+        reasoner.addEvidence(score(i), ev);
+        if (i % 3 == 0) reasoner.removeEvidence(score(i - 2), ev);
+        reasoner.performInference();
+        reasoner.publishSnapshot();
+    }
+
+    done = true;
+    reader.join();
+    if (errors) return 1;
+
+    return 0;
+}
+
+/**
+    The results of bulk builtins in a snapshot describe the values they were computed from, and
+    reading the descriptions must not touch the aggregates the network keeps updating.
+*/
+int aggregateDescriptions()
+{
+    RuleParser parser;
+    Reasoner reasoner;
+    auto rules = parser.parseRules(
+        "[(?player <scored> ?points), GROUP BY (?player), SumBulk(?total ?points),"
+        " MaxBulk(?max ?points) -> (?player <total> ?total), (?player <max> ?max)]",
+        reasoner.net());
+
+    auto ev = std::make_shared<AssertedEvidence>("scores");
+    auto score = [](int i) { return std::make_shared<Triple>("<p1>", "<scored>", std::to_string(i)); };
+    reasoner.addEvidence(score(0), ev);
+    reasoner.performInference();
+    reasoner.publishSnapshot();
+
+    std::atomic<bool> done(false);
+    std::atomic<int> errors(0);
+    std::thread reader(
+        [&]()
+        {
+            while (!done)
+            {
+                auto snapshot = reasoner.getSnapshot();
+                size_t scores = 0;
+                for (auto wme : snapshot->getWMEs())
+                {
+                    auto triple = std::static_pointer_cast<Triple>(wme);
+                    if (triple->predicate == "<scored>") scores++;
+                }
+
+                for (auto wme : snapshot->getWMEs())
+                {
+                    for (auto evidence : snapshot->explain(wme).evidences_)
+                    {
+                        auto inferred = std::dynamic_pointer_cast<InferredEvidence>(evidence);
+                        if (!inferred) continue;
+
+                        auto token = inferred->token();
+                        for (size_t i = 0; i < token->size(); i++)
+                        {
+                            // "sum( 0.000000 1.000000 ) = 1.000000": one value per score
+                            auto description = token->ancestor(i)->wme->getDescription();
+                            if (description.empty()) continue;
+
+                            auto values = std::count(description.begin(), description.end(), ' ');
+                            if (static_cast<size_t>(values) != scores + 3) errors++;
+                        }
+                    }
+                }
+            }
+        }
+    );
+
+    for (int i = 1; i < 100; i++)
+    {
+        reasoner.addEvidence(score(i), ev);
+        if (i % 3 == 0) reasoner.removeEvidence(score(i - 2), ev);
+        reasoner.performInference();
+        reasoner.publishSnapshot();
+    }
+
+    done = true;
+    reader.join();
+    if (errors) return 1;
+
+    return 0;
+}
+
+/**
+    Snapshots of the inference state must be readable from other threads while the reasoner
+    goes on, and must not change after they were published.
+*/
+int main()
+{
+    RuleParser parser;
+    Reasoner reasoner;
+    auto rules = parser.parseRules(
+        "[trans: (?a <p> ?b), (?b <p> ?c) -> (?a <p> ?c)]",
+        reasoner.net());
+
+    // nothing published yet
+    if (reasoner.getSnapshot()->numWMEs() != 0) return 1;
+
+    auto ev = std::make_shared<AssertedEvidence>("chain");
+    reasoner.addEvidence(std::make_shared<Triple>("<n0>", "<p>", "<n1>"), ev);
+    reasoner.performInference();
+    reasoner.publishSnapshot();
+
+    auto first = reasoner.getSnapshot();
+    if (first->numWMEs() != 1) return 2;
+
+    // a reader that checks the snapshots while the chain grows. In a published state every fact
+    // of the transitive closure of the chain <n0> -> ... -> <nk> is known, so k*(k+1)/2 WMEs.
+    std::atomic<bool> done(false);
+    std::atomic<int> errors(0);
+    std::thread reader(
+        [&]()
+        {
+            size_t last = 0;
+            while (!done)
+            {
+                auto snapshot = reasoner.getSnapshot();
+                size_t n = snapshot->numWMEs();
+                size_t k = 0;
+                while (k * (k + 1) / 2 < n) k++;
+                if (k * (k + 1) / 2 != n) errors++;
+                if (n < last) errors++;
+                last = n;
+
+                for (auto wme : snapshot->getWMEs())
+                {
+                    if (snapshot->explain(wme).evidences_.empty()) errors++;
+                }
+            }
+        }
+    );
+
+    for (int i = 1; i < 40; i++)
+    {
+        std::string from = "<n" + std::to_string(i) + ">";
+        std::string to = "<n" + std::to_string(i + 1) + ">";
+        reasoner.addEvidence(std::make_shared<Triple>(from, "<p>", to), ev);
+        reasoner.performInference();
+        reasoner.publishSnapshot();
+    }
+
+    done = true;
+    reader.join();
+    if (errors) return 3;
+
+    // old snapshots stay as they were
+    if (first->numWMEs() != 1) return 4;
+    if (reasoner.getSnapshot()->numWMEs() != 40 * 41 / 2) return 5;
+
+    // the snapshot is only updated when published
+    reasoner.removeEvidence(ev);
+    reasoner.performInference();
+    if (reasoner.getCurrentState().numWMEs() != 0) return 6;
+    if (reasoner.getSnapshot()->numWMEs() != 40 * 41 / 2) return 7;
+    reasoner.publishSnapshot();
+    if (reasoner.getSnapshot()->numWMEs() != 0) return 8;
+
+    int result = groupsAndBuiltins();
+    if (result) return 10 + result;
+
+    result = aggregateDescriptions();
+    if (result) return 20 + result;
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../rete-rdf/ReteRDF.hpp"
+#include "../rete-rdf/TermDictionary.hpp"
+
+using namespace rete;
+
+/**
+    Terms are released with the last triple using them, also when triples are
+    created and dropped on many threads at once.
+*/
+int release()
+{
+    auto& dict = TermDictionary::instance();
+    size_t before = dict.size();
+
+    {
+        Triple t1("<s>", "<p>", "\"unique 1\"");
+        Triple t2("<s>", "<p>", "\"unique 2\"");
+        if (dict.size() != before + 4) return 1;
+
+        {
+            auto copy = std::make_shared<Triple>(t1);
+            if (copy->getFieldID(Triple::OBJECT) != t1.getFieldID(Triple::OBJECT)) return 2;
+        }
+        if (dict.getTerm(t1.getFieldID(Triple::OBJECT)) != "\"unique 1\"") return 3;
+    }
+    if (dict.size() != before) return 4;
+
+    // the IDs of released terms are reused, and unknown IDs are rejected
+    TermDictionary::ID id = dict.getID("\"temporary\"");
+    TermDictionary::release(dict.getTerm(id));
+    bool thrown = false;
+    try { dict.getTerm(id); } catch (std::out_of_range&) { thrown = true; }
+    if (!thrown) return 5;
+    if (dict.getID("\"temporary\"") != id) return 6;
+    TermDictionary::release(dict.getTerm(id));
+
+    // the subject is shared by all threads, the objects by pairs of threads
+    Triple shared("<shared>", "<p>", "<o>");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++)
+    {
+        threads.emplace_back([t]()
+        {
+            for (int i = 0; i < 2000; i++)
+            {
+                Triple triple("<shared>", "<p>", "\"" + std::to_string(t / 2) + " " +
+                                                 std::to_string(i % 50) + "\"");
+                if (TermDictionary::lookup(triple.subject).part().value != "<shared>")
+                    throw std::logic_error("wrong term");
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    if (dict.size() != before + 3) return 7;
+    return 0;
+}
+
+/**
+    Triples intern their terms in the TermDictionary: Equal terms share the
+    same ID and the same stored string.
+*/
+int main()
+{
+    auto& dict = TermDictionary::instance();
+
+    Triple t1("<http://example.com/foo>", "<http://example.com/bar>", "\"baz\"");
+    Triple t2("<http://example.com/foo>", "<http://example.com/foo>", "\"baz\"");
+
+    if (t1.getFieldID(Triple::SUBJECT) != t2.getFieldID(Triple::SUBJECT)) return 1;
+    if (t1.getFieldID(Triple::SUBJECT) != t2.getFieldID(Triple::PREDICATE)) return 2;
+    if (t1.getFieldID(Triple::PREDICATE) == t2.getFieldID(Triple::PREDICATE)) return 3;
+    if (&t1.subject != &t2.predicate) return 4;
+
+    if (dict.getTerm(t1.getFieldID(Triple::OBJECT)) != "\"baz\"") return 5;
+    if (dict.getID("\"baz\"") != t2.getFieldID(Triple::OBJECT)) return 6;
+
+    // the order of triples is still lexicographical
+    Triple a("<a>", "<x>", "<z>");
+    Triple b("<b>", "<x>", "<y>");
+    if (!(a < b) || (b < a)) return 7;
+
+    // TripleParts are handed out by reference
+    if (&t1.getPart(Triple::SUBJECT) != &t2.getPart(Triple::PREDICATE)) return 10;
+    if (&t1.getPart(Triple::OBJECT).value != &t1.object) return 11;
+
+    TripleAccessor acc(Triple::SUBJECT);
+    const TriplePart* part = nullptr;
+    if (!acc.getReference(t1, part) || part != &t1.getPart(Triple::SUBJECT)) return 12;
+
+    // the lexical and numeric forms are parsed once
+    auto& lit = TermDictionary::lookup(dict.getTerm(dict.getID("\"a \\\"quoted\\\" 3.5\"")));
+    std::string lexical;
+    lit.getLexical(lexical);
+    if (lexical != "a \"quoted\" 3.5" || lit.getNumber() != 0.f) return 13;
+
+    Triple num("<x>", "<value>", "\"-2.5\"");
+    float number = 0;
+    TripleAccessor(Triple::OBJECT).getValue(std::make_shared<Triple>(num), number);
+    if (number != -2.5f) return 14;
+
+    size_t before = dict.size();
+
+    Triple t3("<http://example.com/foo>", "<http://example.com/bar>", "\"baz\"");
+    if (dict.size() != before) return 8;
+    if (!(t1 == t3)) return 9;
+
+    int result = release();
+    if (result) return 20 + result;
+
+    return 0;
+}
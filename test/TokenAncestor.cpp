@@ -0,0 +1,78 @@
+#include <iostream>
+
+#include "../rete-core/ReteCore.hpp"
+#include "../rete-rdf/ReteRDF.hpp"
+
+using namespace rete;
+
+/**
+    Tokens give logarithmic time access to their ancestors. Check that this works
+    for chains that share a prefix, and for tokens that were not created
+    through Token::create.
+*/
+int main()
+{
+    std::vector<WME::Ptr> wmes;
+    for (int i = 0; i < 10; i++)
+    {
+        wmes.push_back(std::make_shared<Triple>("<s" + std::to_string(i) + ">", "<p>", "<o>"));
+    }
+
+    // a -- b -- c
+    //       `-- d -- e
+    auto a = Token::create(nullptr, wmes[0]);
+    auto b = Token::create(a, wmes[1]);
+    auto c = Token::create(b, wmes[2]);
+    auto d = Token::create(b, wmes[3]);
+    auto e = Token::create(d, wmes[4]);
+
+    if (a->size() != 1 || c->size() != 3 || e->size() != 4) return 1;
+    if (c->ancestor(0) != c.get() || c->ancestor(1) != b.get() || c->ancestor(2) != a.get()) return 2;
+    if (e->ancestor(1) != d.get() || e->ancestor(2) != b.get() || e->ancestor(3) != a.get()) return 3;
+    if (e->ancestor(4) != nullptr || a->ancestor(1) != nullptr) return 4;
+
+    auto shared = Token::ancestor(e, 2);
+    if (shared != b) return 5;
+
+    // a manually built token on top of a pooled one
+    auto f = std::make_shared<Token>();
+    f->parent = e;
+    f->wme = wmes[5];
+    if (f->size() != 5 || f->ancestor(4) != a.get()) return 6;
+
+    // and a pooled one on top of the manual token
+    auto g = Token::create(f, wmes[6]);
+    if (g->size() != 6 || g->ancestor(1) != f.get() || g->ancestor(5) != a.get()) return 7;
+
+    // the accessors use it, too
+    TripleAccessor acc(Triple::SUBJECT);
+    acc.index() = 4;
+    std::string value;
+    acc.getInterpretation<std::string>()->getValue(g, value);
+    if (value != "s1")
+    {
+        std::cout << value << std::endl;
+        return 8;
+    }
+
+    // a random tree of long chains, compared to walking the parents
+    std::vector<Token::Ptr> tokens { a };
+    for (int i = 0; i < 2000; i++)
+    {
+        auto parent = tokens[(i * 7919) % tokens.size()];
+        if (i % 3) parent = tokens.back();
+        tokens.push_back(Token::create(parent, wmes[i % 10]));
+    }
+
+    for (auto& token : tokens)
+    {
+        Token* t = token.get();
+        for (size_t i = 0; i <= token->size(); i++)
+        {
+            if (token->ancestor(i) != t) return 9;
+            if (t) t = t->parent.get();
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <set>
+#include <thread>
+
+#include "../rete-core/ReteCore.hpp"
+#include "../rete-core/TokenPool.hpp"
+#include "../rete-rdf/ReteRDF.hpp"
+
+using namespace rete;
+
+/**
+    Tokens are allocated from a pool. Released tokens must be reused, and
+    tokens must be releasable on other threads than they were created on,
+    without the pools growing forever.
+*/
+int main()
+{
+    auto wme = std::make_shared<Triple>("<a>", "<b>", "<c>");
+
+    std::vector<Token::Ptr> tokens;
+    std::set<Token*> addresses;
+    Token::Ptr parent;
+    for (int i = 0; i < 2000; i++)
+    {
+        auto t = Token::create(parent, wme);
+        if (t->parent != parent || t->wme != wme) return 1;
+        addresses.insert(t.get());
+        tokens.push_back(t);
+        parent = t;
+    }
+    if (addresses.size() != 2000) return 2;
+
+    // drop the whole chain, the blocks get reused
+    tokens.clear();
+    parent.reset();
+    for (int i = 0; i < 2000; i++)
+    {
+        auto t = Token::create(nullptr, wme);
+        if (addresses.find(t.get()) == addresses.end()) return 3;
+        tokens.push_back(t);
+    }
+
+    // release on another thread
+    std::thread worker([&tokens]() { tokens.clear(); });
+    worker.join();
+    if (!tokens.empty()) return 4;
+
+    // tokens dropped on other threads return to the pool of the thread that created them, so a
+    // thread that keeps creating tokens that others drop does not grow its pool for good
+    size_t chunks = 0;
+    for (int round = 0; round < 20; round++)
+    {
+        for (int i = 0; i < 5000; i++) tokens.push_back(Token::create(nullptr, wme));
+        std::thread reader([&tokens]() { tokens.clear(); });
+        reader.join();
+
+        if (round == 1) chunks = numPoolChunks();
+        if (round > 1 && numPoolChunks() != chunks) return 5;
+    }
+
+    // the pools of threads that ended are reused by the next ones
+    for (int round = 0; round < 20; round++)
+    {
+        std::thread worker(
+            [&tokens, &wme]()
+            {
+                for (int i = 0; i < 5000; i++) tokens.push_back(Token::create(nullptr, wme));
+            });
+        worker.join();
+        tokens.clear();
+
+        if (round == 1) chunks = numPoolChunks();
+        if (round > 1 && numPoolChunks() != chunks) return 6;
+    }
+
+    return 0;
+}
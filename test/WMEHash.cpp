@@ -0,0 +1,55 @@
+#include <iostream>
+
+#include "../rete-core/ReteCore.hpp"
+#include "../rete-rdf/ReteRDF.hpp"
+#include "../rete-rdf/Skolem.hpp"
+
+using namespace rete;
+
+/**
+    Equal WMEs must have equal hash values, else the AlphaMemory will not
+    detect duplicates.
+*/
+int main()
+{
+    Triple t1("<a>", "<b>", "<c>");
+    Triple t2("<a>", "<b>", "<c>");
+    Triple t3("<a>", "<b>", "<d>");
+    if (!(t1 == t2) || t1.hash() != t2.hash()) return 1;
+    if (t1 == t3) return 2;
+
+    Skolem s1("foo"), s2("foo");
+    if (s1.hash() != s2.hash()) return 3;
+
+    TupleWME<std::string, int> tuple1("foo", 1), tuple2("foo", 1);
+    if (tuple1.hash() != tuple2.hash()) return 4;
+
+    // the value of a TupleWME may change
+    tuple2.value_ = std::make_tuple("foo", 2);
+    size_t changed = tuple2.hash();
+    tuple2.value_ = std::make_tuple("foo", 1);
+    if (tuple2.hash() != tuple1.hash()) return 5;
+    if (changed == tuple1.hash()) std::cout << "collision?" << std::endl;
+
+    // equal but different instances end up in the same alpha memory entry
+    Network net;
+    auto root = net.getRoot();
+    TripleTypeAlpha::Ptr typeCheck(new TripleTypeAlpha()); SetParent(root, typeCheck);
+    auto mem = std::make_shared<AlphaMemory>();
+    SetParent(typeCheck, mem);
+
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 100; j++)
+        {
+            auto t = std::make_shared<Triple>("<s" + std::to_string(j) + ">", "<p>", "<o>");
+            root->activate(t, rete::ASSERT);
+        }
+    }
+    if (mem->size() != 100) return 6;
+
+    root->activate(std::make_shared<Triple>("<s42>", "<p>", "<o>"), rete::RETRACT);
+    if (mem->size() != 99) return 7;
+
+    return 0;
+}